@@ -5,20 +5,26 @@ EASE_WATCH_ME;
 
 /*
 clang++ Build.cpp -o Build.exe -std=c++17
+On Linux, where there's only the headless build:
+g++ Build.cpp -o Build.exe -std=c++17 && ./Build.exe --no-watch-source-changed --release
 */
 
 enum Target {
 	Windows,
-	Emscripten
-} target_to = Windows;
+	Emscripten,
+	Linux
+} target_to = Env::Win32 ? Windows : Linux;
 
 void common_build_options(Build& b, Flags& flags) noexcept;
 
 Build build_game(Flags& flags) noexcept;
 Build build_emscripten(Flags& flags) noexcept;
+Build build_headless(Flags& flags) noexcept;
 
 Build build(Flags flags) noexcept {
 	// return build_emscripten(flags);
+	// return build_headless(flags);
+	if constexpr (!Env::Win32) return build_headless(flags);
 
 	if (Env::Win32 && flags.generate_debug) {
 		flags.no_default_lib = true;
@@ -31,6 +37,7 @@ Build build(Flags flags) noexcept {
 	b.add_source_recursively("./src/");
 	b.del_source_recursively("./src/Entry/");
 	b.del_source_recursively("./src/OS/Emscripten");
+	b.del_source_recursively("./src/OS/Linux");
 	b.add_source("./src/Entry/win32_main.cpp");
 
 	common_build_options(b, flags);
@@ -51,6 +58,7 @@ Build build_emscripten(Flags& flags) noexcept {
 	b.add_source_recursively("./src/");
 	b.del_source_recursively("./src/Entry/");
 	b.del_source_recursively("./src/OS/Windows");
+	b.del_source_recursively("./src/OS/Linux");
 	b.del_source_recursively("./src/imgui");
 	b.del_source("./src/Inspector.cpp");
 	b.del_source("./src/GL/gl3w.cpp");
@@ -88,6 +96,40 @@ Build build_emscripten(Flags& flags) noexcept {
 	return b;
 }
 
+Build build_headless(Flags& flags) noexcept {
+	if (Env::Win32 && flags.generate_debug) {
+		flags.no_default_lib = true;
+	}
+
+	auto b = Build::get_default(flags);
+	b.name = "LTW_headless";
+
+	b.add_header("./src/");
+	b.add_source_recursively("./src/");
+	b.del_source_recursively("./src/Entry/");
+	b.del_source_recursively("./src/OS/Emscripten");
+	b.add_source("./src/Entry/headless_main.cpp");
+
+	if constexpr (Env::Win32) {
+		b.del_source_recursively("./src/OS/Linux");
+	} else {
+		b.compiler = "g++";
+		b.del_source_recursively("./src/OS/Windows");
+		b.del_source("./src/imgui/imgui_impl_win32.cpp");
+		b.del_source("./src/Inspector.cpp");
+
+		// Frame pointers for the stack walk of the sampling profiler, and the functions of the
+		// executable in its dynamic symbol table so get_symbol_name can name them.
+		b.add_compile_flag("-fno-omit-frame-pointer");
+		b.add_link_flag("-rdynamic");
+		b.add_library("pthread");
+		b.add_library("dl");
+	}
+
+	common_build_options(b, flags);
+
+	return b;
+}
 
 Build build_game(Flags& flags) noexcept {
 	auto b = Build::get_default(flags);
@@ -253,6 +253,7 @@ struct Build {
 	std::vector<std::filesystem::path> export_files;
 	std::vector<std::filesystem::path> export_dest_files;
 
+	std::vector<std::string> compile_flags;
 	std::vector<std::string> link_flags;
 
 	std::vector<Commands> pre_compile;
@@ -283,6 +284,7 @@ struct Build {
 	void add_export(const std::filesystem::path& f) noexcept;
 	void add_export(const std::filesystem::path& from, const std::filesystem::path& to) noexcept;
 
+	void add_compile_flag(std::string str) noexcept;
 	void add_link_flag(std::string str) noexcept;
 
 	void add_define(std::string str) noexcept;
@@ -667,6 +669,8 @@ const char* NS::Flags::help_install_message() noexcept {
 
 
 
+// libstdc++ has its own since 12.
+#if !defined(_GLIBCXX_RELEASE) || _GLIBCXX_RELEASE < 12
 namespace std {
 	template<>
 	struct hash<std::filesystem::path> {
@@ -675,6 +679,7 @@ namespace std {
 		}
 	};
 };
+#endif
 
 
 size_t NS::Flags::hash() const noexcept {
@@ -869,6 +874,9 @@ void NS::Build::del_source_recursively(const std::filesystem::path& f) noexcept
 	}
 }
 
+void NS::Build::add_compile_flag(std::string str) noexcept {
+	compile_flags.emplace_back(std::move(str));
+}
 void NS::Build::add_link_flag(std::string str) noexcept {
 	link_flags.emplace_back(std::move(str));
 }
@@ -1136,6 +1144,7 @@ NS::Commands compile_command_object(const NS::Build_State& state, const NS::Buil
 		command = b.compiler.generic_string();
 		command += " " + get_cli_flag(b.cli, Cli_Opts::Compile);
 		command += " " + get_cli_flag(b.cli, Cli_Opts::Std_Version, b.std_ver);
+		for (auto& x : b.compile_flags) command += " " + x;
 
 		if (b.flags.openmp)         command += " " + get_cli_flag(b.cli, Cli_Opts::OpenMP);
 		if (b.flags.no_inline)      command += " " + get_cli_flag(b.cli, Cli_Opts::No_Inline);
@@ -1207,6 +1216,7 @@ NS::Commands compile_assembly(const NS::Build_State& state, const NS::Build& b)
 		command = b.compiler.generic_string();
 		command += " " + get_cli_flag(b.cli, Cli_Opts::Compile);
 		command += " " + get_cli_flag(b.cli, Cli_Opts::Std_Version, b.std_ver);
+		for (auto& x : b.compile_flags) command += " " + x;
 		command += " " + get_cli_flag(b.cli, Cli_Opts::Assembly_Output, o.generic_string());
 
 		if (b.flags.compile_native) command += " " + get_cli_flag(b.cli, Cli_Opts::Native);
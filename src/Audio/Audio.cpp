@@ -1,5 +1,6 @@
 #include "Audio/Audio.hpp"
 #include "Managers/AssetsManager.hpp"
+#include "Profiler/Counters.hpp"
 
 
 void audio::Orders::init() noexcept {
@@ -41,6 +42,7 @@ void audio::Orders::callback(void* output, const void* input, ma_uint32 frame_co
 	frame_out.resize(frame_count);
 
 	for (auto& s : playing_sounds) if (!s.to_remove) {
+		PROFILER_COUNTER_ADD("audio voices mixed", 1);
 		auto& decoder = asset::Store.get_sound(s.asset_id);
 		ma_decoder_seek_to_pcm_frame(&decoder, s.current_frame);
 		size_t frame_read = ma_decoder_read_pcm_frames(
@@ -0,0 +1,121 @@
+#include "Bench/Checks.hpp"
+
+#include <cmath>
+#include <stdio.h>
+
+#include "Audio/Audio.hpp"
+#include "Board.hpp"
+#include "dyn_struct.hpp"
+
+static bool check_straight_tunnel() noexcept {
+	constexpr double Dt = 0.05;
+	constexpr float Speed = 120; // 6 units in a step, the unit is less than 0.4 wide.
+
+	audio::Orders audio;
+	Board board;
+	board.presentation = false;
+	// Or the unit is folded into the crowd, where projectiles don't see it.
+	board.crowd_simulation = false;
+	board.tiles.resize(board.size.x * board.size.y, Empty{});
+
+	// The first update sizes the tile tables and computes the paths, after the second the unit
+	// is walking when the projectiles come.
+	board.update(audio, Dt);
+	Unit methane = Methane{};
+	board.spawn_unit_at(methane, Vector2u{ board.size.x / 2, board.size.y / 2 });
+	size_t id = 0;
+	for (auto& u : board.units) id = u.id;
+	board.update(audio, Dt);
+	auto& unit = board.units.id(id);
+	auto health = unit->health;
+
+	auto shoot = [&] (Vector2f offset) {
+		Straight_Projectile p;
+		p.pos = unit->pos + offset - Vector2f{ Speed * (float)Dt / 2, 0 };
+		p.dir = { 1, 0 };
+		p.speed = Speed;
+		p.r = 0.2f;
+		p.damage = 0.5f;
+		board.projectiles.push_back(p);
+		return board.projectiles[board.projectiles.size() - 1].id;
+	};
+
+	// The old test only looked at where the step ended, that's 3 units past the unit.
+	auto hitting = shoot({ 0, 0 });
+	auto missing = shoot({ 0, 1 });
+	auto start = board.projectiles.id(missing)->pos;
+	board.update(audio, Dt);
+
+	bool ok = true;
+	if (board.projectiles.exist(hitting)) {
+		printf("    the projectile went through the unit\n");
+		ok = false;
+	}
+	if (unit->health != health - 0.5f) {
+		printf("    the unit went from %f health to %f\n", health, unit->health);
+		ok = false;
+	}
+	if (!board.projectiles.exist(missing)) {
+		printf("    the projectile passing beside the unit is gone\n");
+		return false;
+	}
+	auto moved = board.projectiles.id(missing)->pos - start;
+	if (std::abs(moved.x - Speed * (float)Dt) > 1e-3f) {
+		printf("    the projectile passing beside the unit moved %f instead of %f\n",
+			moved.x, Speed * Dt
+		);
+		ok = false;
+	}
+	return ok;
+}
+
+static bool check_dyn_struct_copy_after_reference() noexcept {
+	dyn_struct doc = dyn_struct::structure_t{};
+	doc["a"] = dyn_struct::structure_t{};
+	doc["list"] = dyn_struct::array_t{};
+	doc["list"].push_back(1);
+
+	auto& a = doc["a"];
+	auto& first = doc["list"][(size_t)0];
+	dyn_struct copy = doc;
+	a["x"] = 2;
+	first = 3;
+
+	bool ok = true;
+	const dyn_struct& c = copy;
+	if (c["a"].find(xstd::intern("x"))) {
+		printf("    a write through a reference taken before the copy shows in the copy\n");
+		ok = false;
+	}
+	if ((int)c["list"][0] != 1) {
+		printf("    the copy's array went from 1 to %d\n", (int)c["list"][0]);
+		ok = false;
+	}
+	const dyn_struct& d = doc;
+	if (!d["a"].find(xstd::intern("x")) || (int)d["list"][0] != 3) {
+		printf("    the writes didn't make it to the original\n");
+		ok = false;
+	}
+	return ok;
+}
+
+size_t run_checks(std::string_view name) noexcept {
+	struct Check {
+		const char* name;
+		bool (*f)() noexcept;
+	};
+	Check checks[] = {
+		{ "straight_tunnel", check_straight_tunnel },
+		{ "dyn_struct_copy_after_reference", check_dyn_struct_copy_after_reference },
+	};
+
+	size_t ran = 0;
+	size_t failed = 0;
+	for (auto& c : checks) if (name == "all" || name == c.name) {
+		ran++;
+		bool ok = c.f();
+		if (!ok) failed++;
+		printf("%-8s %-56s %s\n", "check", c.name, ok ? "ok" : "FAILED");
+	}
+	return ran ? failed : SIZE_MAX;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+#include <string_view>
+
+// Deterministic checks of behaviors no scenario shows by its numbers, each one sets up the
+// smallest case that went wrong and says whether it still does.
+// The checks:
+// - straight_tunnel: a Straight_Projectile fast enough to jump over a unit in one step, with
+//   neither end of the step touching it, hits it, deals its damage and stops at the contact.
+//   One passing beside it keeps going.
+// - dyn_struct_copy_after_reference: writing through a reference from operator[] taken before
+//   the parent was copied doesn't change the copy.
+
+// name is the name of a check or "all", prints every result as it goes. How many failed, or
+// SIZE_MAX if name is no check.
+extern size_t run_checks(std::string_view name) noexcept;
@@ -0,0 +1,716 @@
+#include "Bench/Micro_Bench.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <float.h>
+#include <sstream>
+#include <stdio.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Graphic/Mesh_Cache.hpp"
+#include "Graphic/Object.hpp"
+#include "OS/file.hpp"
+#include "Profiler/Clock.hpp"
+#include "Profiler/Tracer.hpp"
+#include "std/bloom_filter.hpp"
+#include "std/interned.hpp"
+#include "std/stable_pool.hpp"
+#include "std/swiss_map.hpp"
+#include "std/unordered_map.hpp"
+#include "xstd.hpp"
+
+// What xstd::hash<size_t> is on Emscripten.
+struct Identity_Hash {
+	size_t operator()(size_t x) noexcept { return x; }
+};
+
+// Keeps the compiler from throwing the results away.
+static volatile size_t sink = 0;
+
+struct Rng {
+	std::uint64_t x = 0x853c49e6748fea9bull;
+	size_t operator()(size_t n) noexcept {
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		return (size_t)(x % n);
+	}
+};
+
+struct Micro_Context {
+	std::string_view group;
+	xstd::vector<Micro_Result> results;
+
+	// f does ops operations each time it's called, prepare sets up what it needs beforehand
+	// and isn't timed.
+	template<typename P, typename F>
+	void run(const char* name, size_t ops, P&& prepare, F&& f) noexcept {
+		double best = DBL_MAX;
+		for (size_t i = 0; i < 5; ++i) {
+			prepare();
+			auto start = profiler_ticks();
+			f();
+			best = std::min(best, ticks_to_ns(profiler_ticks() - start));
+		}
+
+		Micro_Result r;
+		r.group = std::string(group);
+		r.name = name;
+		r.ops = ops;
+		r.ns_per_op = best / ops;
+		printf("%-8s %-56s % 10.2lf ns/op\n", r.group.c_str(), name, r.ns_per_op);
+		results.push_back(r);
+	}
+};
+
+// Pool::pool_ids: ids only ever grow, every frame each live id is looked up a few times and
+// a few units die, swap removed, and are replaced by new ones.
+template<typename Map>
+static void bench_pool_ids(Micro_Context& ctx, const char* name) noexcept {
+	constexpr size_t N = 10'000;
+	constexpr size_t Frames = 100;
+	constexpr size_t Churn = 200;
+
+	Map ids;
+	xstd::vector<size_t> live;
+	size_t next_id = 1;
+	Rng rng;
+
+	auto prepare = [&] {
+		ids.clear();
+		live.clear();
+		for (size_t i = 0; i < N; ++i) {
+			ids[next_id] = i;
+			live.push_back(next_id++);
+		}
+	};
+	auto f = [&] {
+		size_t sum = 0;
+		for (size_t frame = 0; frame < Frames; ++frame) {
+			for (auto id : live) sum += ids.contains(id) ? ids.at(id) : 0;
+			for (size_t i = 0; i < Churn; ++i) {
+				size_t r = rng(live.size());
+				ids[live.back()] = r;
+				ids.erase(live[r]);
+				live[r] = live.back();
+				live.pop_back();
+			}
+			for (size_t i = 0; i < Churn; ++i) {
+				ids[next_id] = live.size();
+				live.push_back(next_id++);
+			}
+		}
+		sink = sink + sum;
+	};
+	ctx.run(name, Frames * (N * 2 + Churn * 3), prepare, f);
+}
+
+// Store_t: a few hundred assets keyed by xstd::uuid, nanoseconds << 16 | counter, read every
+// frame, and the path to id maps used when loading.
+template<typename Map>
+static void bench_store_uuid(Micro_Context& ctx, const char* name) noexcept {
+	constexpr size_t N = 300;
+	constexpr size_t Lookups = 1'000'000;
+
+	Map assets;
+	xstd::vector<std::uint64_t> keys;
+	Rng rng;
+	for (size_t i = 0; i < N; ++i) {
+		std::uint64_t ns = 1'700'000'000'000'000'000ull / 65536 + i * 48'271;
+		keys.push_back((ns << 16) | (i & 0xffff));
+		assets[keys.back()] = i;
+	}
+	xstd::vector<std::uint64_t> order;
+	for (size_t i = 0; i < Lookups; ++i) order.push_back(keys[rng(N)]);
+
+	ctx.run(name, Lookups, [] {}, [&] {
+		size_t sum = 0;
+		for (auto k : order) sum += assets.at(k);
+		sink = sink + sum;
+	});
+}
+
+template<typename Map>
+static void bench_store_paths(Micro_Context& ctx, const char* name) noexcept {
+	constexpr size_t N = 300;
+	constexpr size_t Lookups = 200'000;
+
+	Map loaded;
+	xstd::vector<std::string> paths;
+	Rng rng;
+	for (size_t i = 0; i < N; ++i) {
+		paths.push_back("assets/textures/tower_" + std::to_string(i) + "_normal.png");
+		loaded[paths.back()] = i;
+	}
+	// One in ten is a texture not loaded yet.
+	xstd::vector<std::string> order;
+	for (size_t i = 0; i < Lookups; ++i) {
+		order.push_back(rng(10) ? paths[rng(N)] : "assets/textures/new_" + std::to_string(i));
+	}
+
+	ctx.run(name, Lookups, [] {}, [&] {
+		size_t sum = 0;
+		for (auto& p : order) sum += loaded.contains(p);
+		sink = sink + sum;
+	});
+}
+
+// dyn_struct::structure_t: lots of small objects, a tracer event has 8 keys, built once and
+// read back by key. key turns the const char* into what the map is keyed by.
+template<typename Map, typename K>
+static void bench_dyn_struct(Micro_Context& ctx, const char* name, K key) noexcept {
+	constexpr size_t N = 10'000;
+	const char* keys[] = { "name", "cat", "ph", "ts", "dur", "pid", "tid", "args" };
+
+	xstd::vector<Map> objects;
+	ctx.run(name, N * 8 * 2, [&] { objects.clear(); }, [&] {
+		size_t sum = 0;
+		for (size_t i = 0; i < N; ++i) {
+			Map m;
+			for (size_t k = 0; k < 8; ++k) m[key(keys[k])] = i + k;
+			objects.push_back(std::move(m));
+		}
+		for (auto& m : objects) for (auto k : keys) sum += m.at(key(k));
+		sink = sink + sum;
+	});
+}
+
+static void bench_maps(Micro_Context& ctx) noexcept {
+	using hashmap_ids = zedland::hashmap<size_t, size_t>;
+	using swiss_ids = xstd::swiss_map<size_t, size_t>;
+	bench_pool_ids<hashmap_ids>(ctx, "pool ids, hashmap");
+	bench_pool_ids<swiss_ids>(ctx, "pool ids, swiss_map");
+	bench_pool_ids<zedland::hashmap<size_t, size_t, Identity_Hash>>(
+		ctx, "pool ids, hashmap, identity hash"
+	);
+	bench_pool_ids<xstd::swiss_map<size_t, size_t, Identity_Hash>>(
+		ctx, "pool ids, swiss_map, identity hash"
+	);
+
+	using hashmap_uuid = zedland::hashmap<std::uint64_t, size_t>;
+	using swiss_uuid = xstd::swiss_map<std::uint64_t, size_t>;
+	bench_store_uuid<hashmap_uuid>(ctx, "store uuid, hashmap");
+	bench_store_uuid<swiss_uuid>(ctx, "store uuid, swiss_map");
+
+	using hashmap_paths = zedland::hashmap<std::string, size_t>;
+	using swiss_paths = xstd::swiss_map<std::string, size_t>;
+	bench_store_paths<hashmap_paths>(ctx, "store paths, hashmap");
+	bench_store_paths<swiss_paths>(ctx, "store paths, swiss_map");
+
+	auto string_key = [] (const char* x) { return std::string(x); };
+	auto interned_key = [] (const char* x) { return xstd::intern(x); };
+	bench_dyn_struct<hashmap_paths>(ctx, "dyn_struct objects, hashmap", string_key);
+	bench_dyn_struct<swiss_paths>(ctx, "dyn_struct objects, swiss_map", string_key);
+	bench_dyn_struct<zedland::hashmap<xstd::Interned, size_t>>(
+		ctx, "dyn_struct objects, hashmap, interned", interned_key
+	);
+}
+
+// A projectile sized element, 48 bytes.
+struct Vec_Item {
+	size_t a = 0;
+	float b[10] = {};
+};
+
+template<typename Vec, typename T>
+static void bench_push_back(
+	Micro_Context& ctx, const char* name, size_t n, bool reserve
+) noexcept {
+	Vec v;
+	ctx.run(name, n, [&] { v = Vec(); }, [&] {
+		if (reserve) v.reserve(n);
+		for (size_t i = 0; i < n; ++i) v.push_back(T{ i });
+		sink = sink + v.size();
+	});
+}
+
+// Every tenth element goes, the way projectiles and dead units are culled each frame. erase
+// is a callable that takes the vector and the predicate.
+template<typename Vec, typename E>
+static void bench_erase(Micro_Context& ctx, const char* name, E erase) noexcept {
+	constexpr size_t N = 1'000'000;
+
+	Vec v;
+	Rng rng;
+	ctx.run(name, N, [&] {
+		v.clear();
+		for (size_t i = 0; i < N; ++i) v.push_back(rng(N));
+	}, [&] {
+		erase(v, [] (size_t x) { return x % 10 == 0; });
+		sink = sink + v.size();
+	});
+}
+
+// Tower::effects: a lot of small lists of up to 4 elements, made once and read every frame.
+template<typename Vec>
+static void bench_small(
+	Micro_Context& ctx, const char* name_build, const char* name_read
+) noexcept {
+	constexpr size_t N = 10'000;
+	constexpr size_t Per = 3;
+	constexpr size_t Reads = 100;
+
+	xstd::vector<Vec> lists;
+	ctx.run(name_build, N * Per, [&] { lists = {}; }, [&] {
+		for (size_t i = 0; i < N; ++i) {
+			Vec l;
+			for (size_t j = 0; j < Per; ++j) l.push_back(i + j);
+			lists.push_back(std::move(l));
+		}
+	});
+	ctx.run(name_read, N * Per * Reads, [] {}, [&] {
+		size_t sum = 0;
+		for (size_t r = 0; r < Reads; ++r) for (auto& l : lists) for (auto x : l) sum += x;
+		sink = sink + sum;
+	});
+}
+
+static void bench_vectors(Micro_Context& ctx) noexcept {
+	constexpr size_t N = 1'000'000;
+
+	// glibc hands big blocks out of fresh mmaps until one of that size has been freed, so
+	// whichever vector ran first paid a page fault every 4 KB and the other didn't.
+	{
+		xstd::vector<char> warm;
+		warm.resize(4 * N * sizeof(size_t));
+	}
+
+	using xvec = xstd::vector<size_t>;
+	using svec = std::vector<size_t>;
+	bench_push_back<xvec, size_t>(ctx, "push_back size_t, xstd::vector", N, false);
+	bench_push_back<svec, size_t>(ctx, "push_back size_t, std::vector", N, false);
+	bench_push_back<xvec, size_t>(ctx, "push_back size_t, reserved, xstd::vector", N, true);
+	bench_push_back<svec, size_t>(ctx, "push_back size_t, reserved, std::vector", N, true);
+
+	constexpr size_t M = 100'000;
+	using xitems = xstd::vector<Vec_Item>;
+	using sitems = std::vector<Vec_Item>;
+	bench_push_back<xitems, Vec_Item>(ctx, "push_back 48 bytes, xstd::vector", M, false);
+	bench_push_back<sitems, Vec_Item>(ctx, "push_back 48 bytes, std::vector", M, false);
+
+	bench_erase<xvec>(ctx, "erase 10%, xstd::vector::erase", [] (auto& v, auto f) {
+		v.erase(f);
+	});
+	bench_erase<xvec>(ctx, "erase 10%, xstd::remove_all", [] (auto& v, auto f) {
+		xstd::remove_all(v, f);
+	});
+	bench_erase<svec>(ctx, "erase 10%, std::erase_if (keeps order)", [] (auto& v, auto f) {
+		std::erase_if(v, f);
+	});
+
+	bench_small<xstd::small_vector<size_t, 4>>(
+		ctx, "small lists build, small_vector<4>", "small lists read, small_vector<4>"
+	);
+	bench_small<xvec>(ctx, "small lists build, xstd::vector", "small lists read, xstd::vector");
+	bench_small<svec>(ctx, "small lists build, std::vector", "small lists read, std::vector");
+}
+
+// Keys the way they come in: pool ids that only grow, 64 bits hashes or uuids, and
+// addresses or tile indices times a power of two that only differ in their high bits.
+static xstd::vector<size_t> make_keys(
+	const char* distribution, size_t n, size_t seed
+) noexcept {
+	xstd::vector<size_t> keys;
+	Rng rng;
+	rng.x += seed;
+	for (size_t i = 0; i < n; ++i) {
+		if (strcmp(distribution, "sequential") == 0) keys.push_back(seed * n + i + 1);
+		if (strcmp(distribution, "random") == 0)     keys.push_back(rng(SIZE_MAX) | 1);
+		if (strcmp(distribution, "strided") == 0)    keys.push_back((seed * n + i + 1) << 12);
+	}
+	return keys;
+}
+
+// The maps grow by doubling past a load of 0.5, n keys put them at the given load of a
+// table of Table slots once they are all in.
+template<typename Map>
+static void bench_map_load(
+	Micro_Context& ctx, const char* map, const char* distribution, double load
+) noexcept {
+	constexpr size_t Table = 1 << 16;
+	constexpr size_t Lookups = 1'000'000;
+	size_t n = (size_t)(Table * load);
+
+	auto keys = make_keys(distribution, n, 0);
+	auto missing = make_keys(distribution, n, 1);
+	xstd::vector<size_t> order;
+	Rng rng;
+	for (size_t i = 0; i < Lookups; ++i) order.push_back(rng(n));
+
+	char name[128];
+	Map m;
+	snprintf(name, sizeof(name), "%s, %s, load %.2lf, insert", map, distribution, load);
+	ctx.run(name, n, [&] { m = Map(); }, [&] {
+		for (size_t i = 0; i < n; ++i) m[keys[i]] = i;
+		sink = sink + m.size();
+	});
+
+	snprintf(name, sizeof(name), "%s, %s, load %.2lf, find hit", map, distribution, load);
+	ctx.run(name, Lookups, [] {}, [&] {
+		size_t sum = 0;
+		for (auto i : order) sum += m.find(keys[i])->second;
+		sink = sink + sum;
+	});
+
+	snprintf(name, sizeof(name), "%s, %s, load %.2lf, find miss", map, distribution, load);
+	ctx.run(name, Lookups, [] {}, [&] {
+		size_t sum = 0;
+		for (auto i : order) sum += m.find(missing[i]) == m.end();
+		sink = sink + sum;
+	});
+
+	// Half go and come back, what a pool does with its ids over a wave. The tombstones are
+	// left in for whoever comes next.
+	snprintf(name, sizeof(name), "%s, %s, load %.2lf, erase", map, distribution, load);
+	ctx.run(name, n, [] {}, [&] {
+		for (size_t i = 0; i < n; i += 2) m.erase(keys[i]);
+		for (size_t i = 0; i < n; i += 2) m[keys[i]] = i;
+		sink = sink + m.size();
+	});
+}
+
+template<typename Map>
+static void bench_map(Micro_Context& ctx, const char* map) noexcept {
+	for (auto distribution : { "sequential", "random", "strided" }) {
+		bench_map_load<Map>(ctx, map, distribution, 0.26);
+		bench_map_load<Map>(ctx, map, distribution, 0.45);
+	}
+}
+
+static void bench_hashmap(Micro_Context& ctx) noexcept {
+	bench_map<zedland::hashmap<size_t, size_t>>(ctx, "hashmap");
+	bench_map<xstd::swiss_map<size_t, size_t>>(ctx, "swiss_map");
+	bench_map<std::unordered_map<size_t, size_t>>(ctx, "std::unordered_map");
+}
+
+struct Pool_Item {
+	size_t id = 0;
+	bool dead = false;
+	float data[5] = {};
+};
+
+// xstd::Pool with the std containers, the baseline of the pool group.
+template<typename T>
+struct Std_Pool {
+	size_t next_id = 1;
+	std::vector<T> pool;
+	std::unordered_map<size_t, size_t> pool_ids;
+
+	void push_back(const T& v) noexcept {
+		pool.push_back(v);
+		pool.back().id = next_id;
+		pool_ids[next_id++] = pool.size() - 1;
+	}
+
+	template<typename F>
+	void remove_all(F f) noexcept {
+		size_t s = pool.size();
+		for (size_t i = 0; i < s; ++i) if (f(pool[i])) {
+			pool_ids[pool[s - 1].id] = i;
+			pool_ids.erase(pool[i].id);
+			pool[i] = pool[s - 1];
+
+			--i;
+			--s;
+		}
+		pool.resize(s);
+	}
+
+	T& id(size_t id) noexcept { return pool[pool_ids.at(id)]; }
+	bool exist(size_t id) noexcept { return pool_ids.count(id); }
+
+	auto begin() noexcept { return pool.begin(); }
+	auto end() noexcept { return pool.end(); }
+};
+
+// Board::units and projectiles: filled by a wave, looked up by id by the towers and their
+// projectiles, and a few removed every frame.
+template<typename P>
+static void bench_pool(Micro_Context& ctx, const char* pool) noexcept {
+	constexpr size_t N = 50'000;
+	constexpr size_t Lookups = 1'000'000;
+	constexpr size_t Frames = 50;
+	constexpr size_t Churn = N / 50;
+
+	P p;
+	xstd::vector<size_t> ids;
+	auto fill = [&] {
+		p = P();
+		for (size_t i = 0; i < N; ++i) p.push_back(Pool_Item{});
+		ids.clear();
+		for (auto& x : p) ids.push_back(x.id);
+	};
+	Rng rng;
+	xstd::vector<size_t> order;
+	for (size_t i = 0; i < Lookups; ++i) order.push_back(rng(N));
+
+	char name[128];
+	snprintf(name, sizeof(name), "push_back, %s", pool);
+	ctx.run(name, N, [&] { p = P(); }, [&] {
+		for (size_t i = 0; i < N; ++i) p.push_back(Pool_Item{});
+	});
+
+	fill();
+	snprintf(name, sizeof(name), "id, %s", pool);
+	ctx.run(name, Lookups, [] {}, [&] {
+		size_t sum = 0;
+		for (auto i : order) sum += p.id(ids[i]).id;
+		sink = sink + sum;
+	});
+
+	// Every other one is gone.
+	p.remove_all([] (auto& x) { return x.id % 2 == 0; });
+	snprintf(name, sizeof(name), "exist, half dead, %s", pool);
+	ctx.run(name, Lookups, [] {}, [&] {
+		size_t sum = 0;
+		for (auto i : order) sum += p.exist(ids[i]);
+		sink = sink + sum;
+	});
+
+	snprintf(name, sizeof(name), "remove_all 2%% a frame, %s", pool);
+	ctx.run(name, Frames * N, fill, [&] {
+		for (size_t frame = 0; frame < Frames; ++frame) {
+			for (size_t i = 0; i < Churn; ++i) {
+				auto id = ids[rng(N)];
+				if (p.exist(id)) p.id(id).dead = true;
+			}
+			p.remove_all([] (auto& x) { return x.dead; });
+			for (size_t i = 0; i < Churn; ++i) p.push_back(Pool_Item{});
+		}
+	});
+}
+
+static void bench_pools(Micro_Context& ctx) noexcept {
+	bench_pool<xstd::Pool<Pool_Item>>(ctx, "xstd::Pool");
+	bench_pool<xstd::Stable_Pool<Pool_Item>>(ctx, "xstd::Stable_Pool");
+	bench_pool<Std_Pool<Pool_Item>>(ctx, "std::vector + std::unordered_map");
+}
+
+// A few thousand keys in, half the queries aren't there.
+static void bench_bloom(Micro_Context& ctx) noexcept {
+	constexpr size_t N = 4096;
+	constexpr size_t Queries = 1'000'000;
+
+	auto keys = make_keys("random", N, 0);
+	auto missing = make_keys("random", N, 1);
+	xstd::vector<size_t> order;
+	Rng rng;
+	for (size_t i = 0; i < Queries; ++i) order.push_back(rng(N) * 2 + rng(2));
+	auto key = [&] (size_t i) { return i % 2 ? missing[i / 2] : keys[i / 2]; };
+
+	static xstd::bloom_filter_idx<1 << 16, 3> bloom;
+	ctx.run("bloom_filter_idx<64k, 3>, insert", N, [&] { bloom = {}; }, [&] {
+		for (auto k : keys) bloom.insert(k);
+	});
+	ctx.run("bloom_filter_idx<64k, 3>, test", Queries, [] {}, [&] {
+		size_t sum = 0;
+		for (auto i : order) sum += bloom.test(key(i));
+		sink = sink + sum;
+	});
+
+	std::unordered_set<size_t> set;
+	ctx.run("std::unordered_set, insert", N, [&] { set = {}; }, [&] {
+		for (auto k : keys) set.insert(k);
+	});
+	ctx.run("std::unordered_set, contains", Queries, [] {}, [&] {
+		size_t sum = 0;
+		for (auto i : order) sum += set.count(key(i));
+		sink = sink + sum;
+	});
+
+	size_t false_positives = 0;
+	for (auto k : missing) false_positives += bloom.test(k);
+	printf("%-8s %-56s % 10.2lf %%\n", "bloom", "false positives", 100.0 * false_positives / N);
+}
+
+// Object::load_from_file before it mapped the file: read it whole in a string, copy that in a
+// stringstream for the header, push_back each vertex and index. The baseline of the ply group.
+static std::optional<Object> load_ply_stringstream(const std::filesystem::path& path) noexcept {
+	auto opt_str = file::read_whole_text(path);
+	if (!opt_str) return std::nullopt;
+
+	auto& file = *opt_str;
+	Object obj;
+
+	size_t cursor = 0;
+
+	std::string line;
+	std::stringstream file_stream(file);
+
+	size_t n_vertex = 0;
+	size_t n_face   = 0;
+	while (std::getline(file_stream, line)) {
+		cursor += line.size() + 1;
+		if (line.starts_with("comment")) continue;
+		if (line.starts_with("element vertex")) {
+			n_vertex = std::strtoull(line.data() + sizeof("element vertex"), nullptr, 10);
+			continue;
+		}
+		if (line.starts_with("element face")) {
+			n_face = std::strtoull(line.data() + sizeof("element face"), nullptr, 10);
+			continue;
+		}
+		if (line == "end_header") break;
+	}
+
+	for (size_t i = 0; i < n_vertex; ++i) {
+		Object::Vertex temp;
+		memcpy(&temp, file.data() + cursor, sizeof(Object::Vertex));
+
+		obj.vertices.push_back(temp);
+		cursor += sizeof(Object::Vertex);
+	}
+
+	for (size_t i = 0; i < n_face; ++i) {
+		cursor++;
+		for (size_t j = 0; j < 3; ++j) {
+			std::uint32_t x;
+			memcpy(&x, file.data() + cursor, sizeof(x));
+			obj.faces.push_back((std::uint16_t)x);
+			cursor += 4;
+		}
+	}
+
+	Vector3f m{ FLT_MAX, FLT_MAX, FLT_MAX };
+	for (auto& x : obj.vertices) {
+		m.x = std::min(m.x, x.pos.x);
+		m.y = std::min(m.y, x.pos.y);
+		m.z = std::min(m.z, x.pos.z);
+	}
+	for (auto& x : obj.vertices) x.pos -= m;
+
+	for (auto& x : obj.vertices) {
+		obj.size.x = std::max(obj.size.x, x.pos.x);
+		obj.size.y = std::max(obj.size.y, x.pos.y);
+		obj.size.z = std::max(obj.size.z, x.pos.z);
+	}
+
+	return obj;
+}
+
+static bool same_object(const Object& a, const Object& b) noexcept {
+	if (a.vertices.size() != b.vertices.size()) return false;
+	if (a.index_count() != b.index_count()) return false;
+	if (a.size != b.size) return false;
+
+	auto vertex_bytes = a.vertices.size() * sizeof(Object::Vertex);
+	if (memcmp(a.vertices.data(), b.vertices.data(), vertex_bytes) != 0) return false;
+	for (size_t i = 0; i < a.index_count(); ++i) {
+		auto x = a.wide_indices() ? a.faces_32[i] : a.faces[i];
+		auto y = b.wide_indices() ? b.faces_32[i] : b.faces[i];
+		if (x != y) return false;
+	}
+	return true;
+}
+
+// Every model in assets/model, loaded again and again, the way the Store does at startup.
+// Has to run from the repo root.
+static void bench_ply(Micro_Context& ctx) noexcept {
+	constexpr size_t Rounds = 20;
+
+	xstd::vector<std::filesystem::path> paths;
+	std::error_code ec;
+	for (auto& x : std::filesystem::directory_iterator("assets/model", ec)) {
+		if (x.path().extension() != ".ply") continue;
+
+		// The ones it can't read are the ones the old loader read garbage from.
+		auto mapped = Object::load_from_file(x.path());
+		if (!mapped) {
+			auto str = x.path().string();
+			printf("%-8s %-56s\n", "ply", ("skipped " + str).c_str());
+			continue;
+		}
+		auto streamed = load_ply_stringstream(x.path());
+		if (!streamed || !same_object(*streamed, *mapped)) {
+			auto str = x.path().string();
+			printf("%-8s %-56s\n", "ply", ("loaders disagree on " + str).c_str());
+		}
+		paths.push_back(x.path());
+	}
+	if (paths.size() == 0) {
+		printf("%-8s %-56s\n", "ply", "no assets/model/*.ply here");
+		return;
+	}
+
+	ctx.run("load, std::string + std::stringstream", paths.size() * Rounds, [] {}, [&] {
+		size_t sum = 0;
+		for (size_t r = 0; r < Rounds; ++r) for (auto& p : paths) {
+			sum += load_ply_stringstream(p)->vertices.size();
+		}
+		sink = sink + sum;
+	});
+	ctx.run("load, mapped", paths.size() * Rounds, [] {}, [&] {
+		size_t sum = 0;
+		for (size_t r = 0; r < Rounds; ++r) for (auto& p : paths) {
+			sum += Object::load_from_file(p)->vertices.size();
+		}
+		sink = sink + sum;
+	});
+
+	// Cooks the ones that aren't yet, the way the Store would.
+	for (auto& p : paths) sink = sink + mesh::load_object(p)->vertices.size();
+	ctx.run("load, .mesh cache", paths.size() * Rounds, [] {}, [&] {
+		size_t sum = 0;
+		for (size_t r = 0; r < Rounds; ++r) for (auto& p : paths) {
+			sum += mesh::load_cache(p, mesh::cache_path(p))->vertices.size();
+		}
+		sink = sink + sum;
+	});
+}
+
+// What every TIMED_FUNCTION and TIMED_BLOCK costs while a trace session records. Past what the
+// flusher keeps up with the ring drops events, that costs about the same.
+static void bench_tracer(Micro_Context& ctx) noexcept {
+	constexpr size_t N = 100'000;
+
+	auto dir = std::filesystem::temp_directory_path() / "ltw_micro_tracer";
+	auto name = Tracer::intern("micro scope");
+	Tracer::get().begin_session("micro");
+	ctx.run("Scoped_Timer, recording", N, [] {}, [&] {
+		for (size_t i = 0; i < N; ++i) Scoped_Timer timer(Trace_Category::Scope, name);
+	});
+	Tracer::get().end_session(dir);
+
+	std::error_code ec;
+	std::filesystem::remove_all(dir, ec);
+}
+
+dyn_struct micro_report(const xstd::vector<Micro_Result>& results) noexcept {
+	dyn_struct report = dyn_struct::structure_t{};
+	report["micro"] = dyn_struct::array_t{};
+	for (auto& r : results) {
+		dyn_struct x = dyn_struct::structure_t{};
+		x["group"] = r.group;
+		x["name"] = r.name;
+		x["ops"] = r.ops;
+		x["ns_per_op"] = r.ns_per_op;
+		report["micro"].push_back(x);
+	}
+	return report;
+}
+
+xstd::vector<Micro_Result> run_micro_bench(std::string_view group) noexcept {
+	Micro_Context ctx;
+
+	struct Group {
+		const char* name;
+		void (*f)(Micro_Context&) noexcept;
+	};
+	Group groups[] = {
+		{ "maps", bench_maps },
+		{ "vector", bench_vectors },
+		{ "hashmap", bench_hashmap },
+		{ "pool", bench_pools },
+		{ "bloom", bench_bloom },
+		{ "ply", bench_ply },
+		{ "tracer", bench_tracer },
+	};
+
+	for (auto& g : groups) if (group == "all" || group == g.name) {
+		ctx.group = g.name;
+		g.f(ctx);
+	}
+	return std::move(ctx.results);
+}
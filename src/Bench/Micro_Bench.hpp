@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "dyn_struct.hpp"
+#include "std/vector.hpp"
+
+// Microbenchmarks of the containers the rest is built on, each one repeating the access
+// pattern of the code that uses them with made up data. A change to one of them shows up
+// everywhere at once and too little in any one scenario to be seen.
+// The groups:
+// - maps: zedland::hashmap against xstd::swiss_map, the way Pool ids, the asset Store and
+//   dyn_struct objects use them, and dyn_struct objects keyed by xstd::Interned.
+// - vector: xstd::vector push_back, reserve and erase, and small_vector for short lists.
+// - hashmap: insert, find and erase at two loads, with sequential, random and strided keys.
+// - pool: Pool and Stable_Pool push_back, id, exist and remove_all.
+// - bloom: bloom_filter_idx insert and test.
+// Each has the std container doing the same thing next to it.
+// - ply: Object::load_from_file on every assets/model/*.ply, against the loader it replaced,
+//   and the same models from their .mesh cache.
+// - tracer: a Scoped_Timer while a trace session records.
+struct Micro_Result {
+	std::string group;
+	std::string name;
+	size_t ops = 0;
+	// Best of a few runs.
+	double ns_per_op = 0;
+};
+
+// group is the name of a group or "all", prints every result as it goes.
+extern xstd::vector<Micro_Result> run_micro_bench(std::string_view group) noexcept;
+
+// { micro: [{group, name, ops, ns_per_op}] }
+extern dyn_struct micro_report(const xstd::vector<Micro_Result>& results) noexcept;
@@ -0,0 +1,179 @@
+#include "Bench/Regression_Gate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+#include "Bench/Scenario.hpp"
+#include "std/vector.hpp"
+#include "xstd.hpp"
+
+// The resamples are the same from one gate to the next.
+struct Bootstrap_Rng {
+	std::uint64_t x = 0x853c49e6748fea9bull;
+	size_t operator()(size_t n) noexcept {
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		return (size_t)(x % n);
+	}
+};
+
+static double median(xstd::vector<double>& x) noexcept {
+	if (x.empty()) return 0;
+	std::sort(BEG_END(x));
+	size_t h = x.size() / 2;
+	return x.size() % 2 ? x[h] : (x[h - 1] + x[h]) / 2;
+}
+static double median(std::span<const double> x) noexcept {
+	xstd::vector<double> copy;
+	for (auto& y : x) copy.push_back(y);
+	return median(copy);
+}
+
+// Median of as many draws from x, with replacement, as x has values.
+static double resampled_median(
+	std::span<const double> x, Bootstrap_Rng& rng, xstd::vector<double>& buffer
+) noexcept {
+	buffer.clear();
+	for (size_t i = 0; i < x.size(); ++i) buffer.push_back(x[rng(x.size())]);
+	return median(buffer);
+}
+
+static double quantile(xstd::vector<double>& x, double q) noexcept {
+	std::sort(BEG_END(x));
+	return x[(size_t)(std::clamp(q, 0.0, 1.0) * (x.size() - 1))];
+}
+
+// Counters are often 0, from 0 to anything is a 100% change.
+static double relative_change(double before, double now) noexcept {
+	return before > 0 ? now / before - 1 : (now > 0 ? 1.0 : 0.0);
+}
+
+Run_Comparison compare_runs(
+	std::span<const double> before,
+	std::span<const double> now,
+	double tolerance,
+	double alpha,
+	std::span<const double> again
+) noexcept {
+	constexpr size_t Resamples = 2000;
+
+	Run_Comparison result;
+	if (before.empty() || now.empty()) return result;
+
+	result.before = median(before);
+	result.now = median(now);
+	result.change = relative_change(result.before, result.now);
+
+	Bootstrap_Rng rng;
+	xstd::vector<double> buffer;
+	xstd::vector<double> changes;
+	xstd::vector<double> noise;
+	for (size_t i = 0; i < Resamples; ++i) {
+		auto b = resampled_median(before, rng, buffer);
+		auto n = resampled_median(now, rng, buffer);
+		changes.push_back(relative_change(b, n));
+
+		// A/A, two resamples of the same side.
+		for (auto side : { before, now }) {
+			auto x = resampled_median(side, rng, buffer);
+			auto y = resampled_median(side, rng, buffer);
+			noise.push_back(std::abs(relative_change(x, y)));
+		}
+		if (!again.empty()) {
+			auto x = resampled_median(before, rng, buffer);
+			auto y = resampled_median(again, rng, buffer);
+			noise.push_back(std::abs(relative_change(x, y)));
+		}
+	}
+
+	result.lower = quantile(changes, alpha);
+	result.noise_floor = quantile(noise, 1 - alpha);
+	result.regressed = result.lower > std::max(tolerance, result.noise_floor);
+	return result;
+}
+
+// The value of name in every run of scenario, in group if there's one. 0 for the runs that
+// don't have it, a phase that didn't run took no time.
+static xstd::vector<double> per_run(
+	const dyn_struct& scenario, const char* group, std::string_view name
+) noexcept {
+	xstd::vector<double> result;
+	for (auto& run : iterate_array(scenario["runs"])) {
+		const dyn_struct* x = &run;
+		if (group) x = has(run, group) ? &run[group] : nullptr;
+		result.push_back(x && has(*x, name) ? (double)(*x)[name] : 0.0);
+	}
+	return result;
+}
+
+size_t regression_gate(
+	const dyn_struct& before,
+	const dyn_struct& now,
+	double tolerance,
+	double alpha,
+	const dyn_struct* again
+) noexcept {
+	size_t regressions = 0;
+
+	auto compare = [&] (
+		std::string_view what,
+		const dyn_struct& a,
+		const dyn_struct& b,
+		const dyn_struct* a_again,
+		const char* group
+	) {
+		auto x = per_run(a, group, what);
+		auto y = per_run(b, group, what);
+		xstd::vector<double> z;
+		if (a_again) z = per_run(*a_again, group, what);
+		auto c = compare_runs(
+			{ x.data(), x.size() }, { y.data(), y.size() }, tolerance, alpha, { z.data(), z.size() }
+		);
+		regressions += c.regressed;
+
+		printf(
+			"  %-40.*s % 12.4lf -> % 12.4lf  %+7.1lf%%"
+			"  at least %+7.1lf%%  noise %5.1lf%%%s\n",
+			(int)what.size(), what.data(),
+			c.before,
+			c.now,
+			c.change * 100,
+			c.lower * 100,
+			c.noise_floor * 100,
+			c.regressed ? "  REGRESSED" : ""
+		);
+	};
+
+	for (auto& b : iterate_array(now["scenarios"])) {
+		auto name = (std::string)b["name"];
+		auto found = find_scenario(before, name);
+		if (!found) {
+			printf("%s: not in the baseline\n", name.c_str());
+			continue;
+		}
+		auto& a = *found;
+		if (!has(a, "runs") || !has(b, "runs") || size(b["runs"]) == 0) {
+			printf("%s: no runs to compare, one of the reports is too old\n", name.c_str());
+			continue;
+		}
+		printf("%s, %zu runs -> %zu runs\n", name.c_str(), size(a["runs"]), size(b["runs"]));
+
+		const dyn_struct* a_again = again ? find_scenario(*again, name) : nullptr;
+		if (a_again && !has(*a_again, "runs")) a_again = nullptr;
+
+		// What's in the first run of now, the others have the same.
+		auto& first = b["runs"][0];
+		compare("frame_median_ms", a, b, a_again, nullptr);
+		compare("frame_p95_ms", a, b, a_again, nullptr);
+		for (auto [phase, x] : iterate_structure(first["phases"])) {
+			compare(phase, a, b, a_again, "phases");
+		}
+		for (auto [counter, x] : iterate_structure(first["counters"])) {
+			compare(counter, a, b, a_again, "counters");
+		}
+	}
+
+	return regressions;
+}
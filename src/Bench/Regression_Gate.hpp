@@ -0,0 +1,48 @@
+#pragma once
+
+#include <span>
+
+#include "dyn_struct.hpp"
+
+// Frame times are noisy, a run can be 5% slower than the one before without anything changing,
+// and the frames of one run aren't independent samples: a slow stretch of the machine makes
+// hundreds of slow frames in a row. So the gate doesn't test frames, it tests runs. Each run of
+// a scenario is reduced to a few numbers (its frame median and p95, the mean ms per frame of
+// every TIMED_BLOCK phase, the mean of every counter per frame) and the runs of each side are
+// compared as a whole, see --runs in Entry/headless_main.cpp.
+// Something regressed when the median over the runs grew by more than tolerance and by more
+// than the noise floor, even at the low end of a bootstrap over the runs. The noise floor is
+// A/A: how much the median moves between two resamples of the same side, and between before
+// and a second report of the same build when there's one. Runs of one invocation share more
+// than runs of two, the machine drifts, that second report is what measures it.
+// With one run a side there is no noise to measure and it's a plain comparison to tolerance.
+
+struct Run_Comparison {
+	// Medians over the runs.
+	double before = 0;
+	double now = 0;
+	double change = 0;
+	// The change is larger than that with probability 1 - alpha.
+	double lower = 0;
+	double noise_floor = 0;
+	bool regressed = false;
+};
+
+// One value per run on each side, again is the same build as before run another time, if any.
+extern Run_Comparison compare_runs(
+	std::span<const double> before,
+	std::span<const double> now,
+	double tolerance,
+	double alpha,
+	std::span<const double> again = {}
+) noexcept;
+
+// Prints every comparison and returns the number of regressions, 0 when before and now have no
+// runs in common.
+extern size_t regression_gate(
+	const dyn_struct& before,
+	const dyn_struct& now,
+	double tolerance,
+	double alpha,
+	const dyn_struct* again = nullptr
+) noexcept;
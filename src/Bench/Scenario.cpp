@@ -0,0 +1,295 @@
+#include "Bench/Scenario.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include "Audio/Audio.hpp"
+#include "OS/Process.hpp"
+#include "Profiler/Tracer.hpp"
+#include "Board.hpp"
+
+Allocation_Counters allocation_counters;
+
+template<typename T>
+static void add_tower(Scenario& s, T t, Vector2u tile_pos) noexcept {
+	t.tile_pos = tile_pos;
+	s.towers.push_back(t);
+}
+
+xstd::vector<Scenario> get_all_scenarios() noexcept {
+	xstd::vector<Scenario> scenarios;
+
+	{
+		Scenario s;
+		s.name = "wave_60_mirrors";
+		for (size_t i = 0; i < 10; ++i) for (size_t j = 0; j < 4; ++j)
+			add_tower(s, Mirror{}, {4 + i * 5, 2 + j * 4});
+		s.waves.push_back(gen_wave(60));
+		scenarios.push_back(std::move(s));
+	}
+
+	{
+		Scenario s;
+		s.name = "volter_surge_storm";
+		for (size_t i = 0; i < 6; ++i) {
+			Volter v;
+			v.always_surge = true;
+			v.surge_time = 1.f;
+			size_t y = (i % 2) ? 13 : 2;
+			add_tower(s, v, {6 + i * 8, y});
+		}
+		s.waves.push_back(gen_wave(30));
+		s.waves.push_back(gen_wave(31));
+		scenarios.push_back(std::move(s));
+	}
+
+	{
+		Scenario s;
+		s.name = "split_chain_cascade";
+		for (size_t i = 0; i < 12; ++i) {
+			Radiation r;
+			r.target_id = 0;
+			r.target_mode = Tower_Target::First;
+			size_t y = (i % 2) ? 4 : 14;
+			add_tower(s, r, {5 + i * 4, y});
+		}
+		s.waves.push_back(gen_wave(40));
+		s.waves.push_back(gen_wave(41));
+		scenarios.push_back(std::move(s));
+	}
+
+	{
+		Scenario s;
+		s.name = "water_merge_chain";
+		for (size_t i = 0; i < 8; ++i) {
+			add_tower(s, Heat{},   {6 + i * 6, 4});
+			add_tower(s, Mirror{}, {6 + i * 6, 14});
+		}
+
+		Wave w;
+		Wave::Bunch b;
+		b.add_unit(Water(), 2000);
+		b.add_unit(Methane(), 4000);
+		b.duration = 10;
+		w.add_bunch(b, 0);
+		s.waves.push_back(w);
+		scenarios.push_back(std::move(s));
+	}
+
+	{
+		Scenario s;
+		s.name = "methane_100k_1000x1000";
+		s.size = {1000, 1000};
+		s.seconds = 30;
+		for (size_t i = 0; i < 40; ++i)
+			add_tower(s, Mirror{}, {900 + (i % 8) * 10, 300 + (i / 8) * 100});
+
+		Wave w;
+		Wave::Bunch b;
+		b.add_unit(Methane(), 100'000);
+		b.duration = 20;
+		w.add_bunch(b, 0);
+		s.waves.push_back(w);
+		scenarios.push_back(std::move(s));
+	}
+
+	return scenarios;
+}
+
+struct Phase_Stat {
+	const char* name = nullptr;
+	std::uint64_t total = 0; // profiler ticks
+	std::uint64_t max = 0;
+	size_t calls = 0;
+
+	// Time spent in the phase every frame, 0 when it didn't run.
+	std::uint64_t frame = 0;
+	xstd::vector<float> frame_ms;
+};
+
+static void collect_samples(
+	xstd::vector<Phase_Stat>& phases, size_t& dropped, size_t frames_before
+) noexcept {
+	auto frame = current_sample_frame();
+	dropped += dropped_samples(frame);
+
+	for_each_sample(frame, [&] (const Sample& s) {
+		auto dt = s.time_end - s.time_start;
+
+		Phase_Stat* stat = nullptr;
+		for (auto& p : phases) if (strcmp(p.name, s.function_name) == 0) { stat = &p; break; }
+		if (!stat) {
+			phases.push_back({ .name = s.function_name });
+			stat = &phases.back();
+			stat->frame_ms.resize(frames_before, 0.f);
+		}
+
+		stat->total += dt;
+		stat->max = std::max(stat->max, dt);
+		stat->calls++;
+		stat->frame += dt;
+	});
+
+	for (auto& p : phases) {
+		p.frame_ms.push_back((float)ticks_to_ms(p.frame));
+		p.frame = 0;
+	}
+}
+
+template<typename T>
+static dyn_struct to_array(const xstd::vector<T>& x) noexcept {
+	dyn_struct result = dyn_struct::array_t{};
+	for (auto& y : x) result.push_back(y);
+	return result;
+}
+
+dyn_struct run_scenario(
+	const Scenario& scenario, Profile_Tree* profile, Frame_Watchdog* watchdog
+) noexcept {
+	thread_local audio::Orders muted_audio;
+
+	size_t alloc_count = allocation_counters.count;
+	size_t alloc_bytes = allocation_counters.bytes;
+	allocation_counters.peak = (size_t)allocation_counters.live;
+
+	xstd::seed(scenario.seed);
+
+	Board board;
+	board.size = scenario.size;
+	board.presentation = false;
+	board.tiles.resize(board.size.x * board.size.y, Empty{});
+	for (auto& t : scenario.towers) if (board.can_place_at(t->tile_rec())) board.insert_tower(t);
+
+	size_t wave_idx = 0;
+	if (!scenario.waves.empty()) board.current_wave = scenario.waves[0];
+
+	xstd::vector<Phase_Stat> phases;
+	size_t samples_dropped = 0;
+	xstd::vector<double> frame_ms;
+	size_t max_units = 0;
+	size_t max_crowd = 0;
+	size_t max_projectiles = 0;
+	Ressources gained = {};
+	std::int64_t counter_total[Counter_Registry::MAX_COUNTER] = {};
+	std::int64_t counter_max[Counter_Registry::MAX_COUNTER] = {};
+	xstd::vector<std::int64_t> counter_frames[Counter_Registry::MAX_COUNTER];
+
+	next_sample_frame();
+	for (double t = 0; t < scenario.seconds; t += scenario.step) {
+		size_t next_wave = (size_t)(t / scenario.wave_interval);
+		if (next_wave != wave_idx && next_wave < scenario.waves.size()) {
+			wave_idx = next_wave;
+			board.current_wave = scenario.waves[wave_idx];
+		}
+
+		auto start = profiler_ticks();
+		board.update(muted_audio, std::min(scenario.step, scenario.seconds - t));
+		frame_ms.push_back(ticks_to_ms(profiler_ticks() - start));
+		set_entity_gauges({ &board, 1 });
+
+		collect_samples(phases, samples_dropped, frame_ms.size() - 1);
+		if (profile) profile->add_frame(current_sample_frame());
+		next_sample_frame();
+		xstd::frame_arena().reset();
+		if (watchdog) watchdog->end_frame([&] { return board.snapshot(); }, frame_ms.back());
+
+		for (size_t i = 0; i < counter_registry.count; ++i) {
+			auto v = counter_value(current_sample_frame() - 1, i).value_or(0);
+			if (counter_frames[i].size() + 1 < frame_ms.size()) {
+				counter_frames[i].resize(frame_ms.size() - 1, 0);
+			}
+			counter_frames[i].push_back(v);
+			counter_total[i] += v;
+			counter_max[i] = std::max(counter_max[i], v);
+		}
+
+		gained = add(gained, board.ressources_gained);
+
+		max_units = std::max(max_units, board.units.size());
+		max_crowd = std::max(max_crowd, board.crowd_size());
+		max_projectiles = std::max(max_projectiles, board.projectiles.size());
+	}
+
+	dyn_struct report = dyn_struct::structure_t{};
+	report["name"] = scenario.name;
+	report["seed"] = scenario.seed;
+	report["seconds"] = scenario.seconds;
+	report["frames"] = frame_ms.size();
+
+	dyn_struct& frame = report["frame_ms"] = dyn_struct::structure_t{};
+	frame["frames"] = to_array(frame_ms);
+
+	double sum = 0;
+	for (auto& x : frame_ms) sum += x;
+	std::sort(BEG_END(frame_ms));
+	double p50 = frame_ms.empty() ? 0.0 : frame_ms[(frame_ms.size() - 1) / 2];
+	double p95 = frame_ms.empty() ? 0.0 : frame_ms[(frame_ms.size() - 1) * 95 / 100];
+	frame["mean"] = frame_ms.empty() ? 0.0 : sum / frame_ms.size();
+	frame["p95"] = p95;
+	frame["max"] = frame_ms.empty() ? 0.0 : frame_ms.back();
+	frame["total"] = sum;
+
+	// This run for regression_gate, run_bench adds the others.
+	double n_frames = (double)std::max<size_t>(frame_ms.size(), 1);
+	dyn_struct run = dyn_struct::structure_t{};
+	run["frame_median_ms"] = p50;
+	run["frame_p95_ms"] = p95;
+	dyn_struct& run_phases = run["phases"] = dyn_struct::structure_t{};
+	for (auto& p : phases) run_phases[p.name] = ticks_to_ms(p.total) / n_frames;
+	dyn_struct& run_counters = run["counters"] = dyn_struct::structure_t{};
+	for (size_t i = 0; i < counter_registry.count; ++i) {
+		run_counters[counter_registry.names[i]] = counter_total[i] / n_frames;
+	}
+	report["runs"] = dyn_struct::array_t{};
+	report["runs"].push_back(run);
+
+	dyn_struct& phase = report["phases"] = dyn_struct::structure_t{};
+	for (auto& p : phases) {
+		dyn_struct& x = phase[p.name] = dyn_struct::structure_t{};
+		x["total_ms"] = ticks_to_ms(p.total);
+		x["max_ms"] = ticks_to_ms(p.max);
+		x["calls"] = p.calls;
+		x["frames"] = to_array(p.frame_ms);
+	}
+
+	report["dropped_samples"] = samples_dropped;
+
+	dyn_struct& counters = report["counters"] = dyn_struct::structure_t{};
+	for (size_t i = 0; i < counter_registry.count; ++i) {
+		dyn_struct& x = counters[counter_registry.names[i]] = dyn_struct::structure_t{};
+		// A gauge summed over frames means nothing, its last value does.
+		if (counter_registry.kinds[i] == Counter_Kind::Gauge) {
+			x["last"] = counter_frames[i].empty() ? 0 : counter_frames[i].back();
+		} else {
+			x["total"] = counter_total[i];
+		}
+		x["max"] = counter_max[i];
+		x["frames"] = to_array(counter_frames[i]);
+	}
+
+	dyn_struct& entities = report["entities"] = dyn_struct::structure_t{};
+	entities["towers"] = board.towers.size();
+	entities["max_units"] = max_units;
+	entities["max_crowd"] = max_crowd;
+	entities["max_projectiles"] = max_projectiles;
+	entities["units_left"] = board.units.size() + board.crowd_size();
+
+	dyn_struct& allocations = report["allocations"] = dyn_struct::structure_t{};
+	allocations["count"] = allocation_counters.count - alloc_count;
+	allocations["bytes"] = allocation_counters.bytes - alloc_bytes;
+	allocations["peak_live_bytes"] = (size_t)allocation_counters.peak;
+
+	report["peak_memory"] = get_peak_memory_usage();
+	report["gold"] = gained.gold;
+
+	return report;
+}
+
+const dyn_struct* find_scenario(const dyn_struct& report, std::string_view name) noexcept {
+	if (!has(report, "scenarios")) return nullptr;
+	for (auto& x : iterate_array(report["scenarios"])) {
+		if (has(x, "name") && (std::string)x["name"] == name) return &x;
+	}
+	return nullptr;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+
+#include "dyn_struct.hpp"
+#include "std/vector.hpp"
+
+#include "Profiler/Frame_Watchdog.hpp"
+#include "Profiler/Profile_Tree.hpp"
+#include "Tower.hpp"
+#include "Wave.hpp"
+
+// A named, reproducible load for the simulation: a board, towers already placed and a list of
+// waves, run for a fixed amount of game time from a fixed seed. Nothing is rendered or heard.
+struct Scenario {
+	const char* name = "";
+
+	Vector2u size = {60, 20};
+	size_t seed = 0;
+
+	double seconds = 60;
+	double step = 1 / 60.0;
+
+	// A new wave from waves is started every wave_interval seconds, the last one is kept.
+	double wave_interval = 30;
+
+	xstd::vector<Tower> towers;
+	xstd::vector<Wave> waves;
+};
+
+extern xstd::vector<Scenario> get_all_scenarios() noexcept;
+
+// Runs the scenario on a fresh board and returns its report:
+// { name, frames, seconds, frame_ms {mean, p95, max, frames},
+//   phases {name: {total_ms, calls, max_ms, frames}},
+//   entities {towers, max_units, max_crowd, max_projectiles},
+//   counters {name: {total or last, max, frames}},
+//   allocations {count, bytes, peak_live_bytes}, peak_memory, dropped_samples,
+//   runs [{frame_median_ms, frame_p95_ms, phases {name: ms per frame},
+//          counters {name: mean per frame}}] }
+// frames is the value of every frame, in order. Counters have a total, gauges their last
+// value. runs has this run only, what regression_gate compares, run_bench appends the runs
+// that follow to it.
+// When profile is given every frame is also folded in it, when watchdog is given it watches
+// the time board.update takes.
+extern dyn_struct run_scenario(
+	const Scenario& scenario, Profile_Tree* profile = nullptr, Frame_Watchdog* watchdog = nullptr
+) noexcept;
+
+// The report of the scenario named name in a report of several, nullptr if it's not there.
+extern const dyn_struct* find_scenario(const dyn_struct& report, std::string_view name) noexcept;
+
+// Only moving when the executable counts its allocations, see Entry/headless_main.cpp.
+struct Allocation_Counters {
+	std::atomic<size_t> count = 0;
+	std::atomic<size_t> bytes = 0;
+	std::atomic<size_t> live  = 0;
+	std::atomic<size_t> peak  = 0;
+
+	void on_alloc(size_t n) noexcept {
+		count++;
+		bytes += n;
+		size_t now = live += n;
+		size_t p = peak;
+		while (now > p && !peak.compare_exchange_weak(p, now));
+	}
+	void on_free(size_t n) noexcept { live -= n; }
+};
+extern Allocation_Counters allocation_counters;
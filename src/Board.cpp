@@ -21,6 +21,11 @@ void Board::update(audio::Orders& audio_orders, double dt) noexcept {
 	TIMED_FUNCTION;
 	seconds_elapsed += dt;
 	if (tiles.size() != size.x * size.y) tiles.resize(size.x * size.y, Empty{});
+	if (unit_kind_count_by_tile.size() != size.x * size.y * Unit::Count) {
+		unit_kind_count_by_tile.clear();
+		unit_kind_count_by_tile.resize(size.x * size.y * Unit::Count, 0);
+		for (auto& x : units) if (!x.to_remove) unit_enter_tile(x);
+	}
 
 	if (path_construction.soft_dirty) soft_compute_paths();
 	else if (path_construction.dirty) compute_paths();
@@ -28,17 +33,26 @@ void Board::update(audio::Orders& audio_orders, double dt) noexcept {
 	ressources_gained = {};
 	current_wave.spawn(dt, *this);
 
-	for (auto& x : tiles) {
+	if (presentation) for (auto& x : tiles) {
 		auto d = (x->target_color - x->color).length();
 		d = std::max(d, 0.1f);
 		x->color += (x->target_color - x->color).normed() * d * dt;
 	}
 
+	{
+	TIMED_BLOCK("Crowd");
+	if (crowd_simulation) {
+		compute_hot_tiles(dt);
+		crowd_update(dt);
+	}
+	}
+
 	{
 	TIMED_BLOCK("Units");
 	for (auto& x : units) {
 		x->life_time += dt;
 		x->invincible -= dt;
+		x->last_pos = x->pos;
 	}
 
 	for (auto& x : units) if (!x.to_remove) {
@@ -51,21 +65,30 @@ void Board::update(audio::Orders& audio_orders, double dt) noexcept {
 
 		auto dt_vec = next_pos - x->pos;
 
-		if (dt_vec.length2() < (last_pos - x->pos).length2()) x->current_tile = x->target_tile;
+		if (dt_vec.length2() < (last_pos - x->pos).length2()) {
+			unit_leave_tile(x);
+			x->current_tile = x->target_tile;
+			unit_enter_tile(x);
+		}
 
 		dt_vec = dt_vec.normed();
 		x->pos += dt_vec * x->speed * dt;
 
-		if (x->current_tile < size.y) x.to_remove = true;
+		if (x->current_tile < size.y) {
+			unit_leave_tile(x);
+			x.to_remove = true;
+		}
 	}
 	
 	for (auto& x : units) if (!x.to_remove) {
 		if (x->health <= 0) {
-			if (!x.to_remove) x->to_die = true;
+			unit_leave_tile(x);
+			x->to_die = true;
 			x.to_remove = true;
 		}
 	}
 
+	crowd_demote();
 	unit_spatial_partition();
 	}
 
@@ -75,7 +98,7 @@ void Board::update(audio::Orders& audio_orders, double dt) noexcept {
 
 	{
 	TIMED_BLOCK("Towers");
-	for (size_t i = 0; i < towers.size(); ++i) {
+	for (size_t i = 0; i < towers.slot_count(); ++i) if (towers.occupied(i)) {
 		Vector2f tower_pos = tile_box(towers[i]->tile_pos, towers[i]->tile_size).center();
 		auto base = towers[i].base();
 
@@ -163,6 +186,7 @@ void Board::update(audio::Orders& audio_orders, double dt) noexcept {
 
 		bool   hit = false;
 		size_t unit_hit = 0;
+		float  step_left = 1.f;
 
 		y.on_one_off(PROJ_SEEK_LIST) (auto& x) {
 			if (!units.exist(x.to)) { y.to_remove = true; return; }
@@ -179,33 +203,15 @@ void Board::update(audio::Orders& audio_orders, double dt) noexcept {
 		};
 
 		y.on_one_off(PROJ_STRAIGHT_LIST) (auto& x) {
-			Vector2u proj_tile;
-			proj_tile.x = (size_t)std::clamp(
-				(x.pos.x + bounding_tile_size() * size.x / 2.f) / bounding_tile_size(),
-				0.f,
-				size.x - 1.f
-			);
-			proj_tile.y = (size_t)std::clamp(
-				(x.pos.y + bounding_tile_size() * size.y / 2.f) / bounding_tile_size(),
-				0.f,
-				size.y - 1.f
-			);
-
-			for (int off_x = -1; off_x <= 1; ++off_x) for (int off_y = -1; off_y <= 1; ++off_y)
-			if (size.x > proj_tile.x + off_x && size.y > proj_tile.y + off_y) {
-				auto vec = Vector2u{proj_tile.x + off_x, proj_tile.y + off_y};
-				for (auto& u_id : unit_idx_by_tile[vec_to_idx(vec)]) {
-					auto& u = units[u_id];
-					if (u.to_remove) continue;
-					auto d = (x.pos - u->pos).length2();
-
-					if (d < x.r * x.r) {
-						hit = true;
-						unit_hit = u.id;
-						return;
-					}
-				}
-			}
+			auto to = x.pos + x.dir * x.speed * dt;
+			auto sweep = sweep_units(x.pos, to, x.r);
+			if (!sweep) return;
+
+			// It stops where it touched, the hit behaviors decide what happens next.
+			hit = true;
+			unit_hit = sweep->unit_id;
+			x.pos += (to - x.pos) * sweep->t;
+			step_left = 0.f;
 		};
 		
 		y.on_one_off(PROJ_TARGET_LIST) (auto& x) {
@@ -224,6 +230,7 @@ void Board::update(audio::Orders& audio_orders, double dt) noexcept {
 					p.max_split --;
 					proj_to_add.push_back(p);
 					
+					if (!presentation) continue;
 					audio::Sound s;
 					s.asset_id = asset::Sound_Id::Die;
 					s.volume = 0.1f;
@@ -295,14 +302,13 @@ void Board::update(audio::Orders& audio_orders, double dt) noexcept {
 			}
 		};
 
-		y->pos += y->dir * y->speed * dt;
+		y->pos += y->dir * y->speed * dt * step_left;
 	}
 	}
 
 	{
 	TIMED_BLOCK("Units");
-	for (size_t i = 0; i < units.size(); ++i) {
-		auto& x = units[i];
+	for (auto& x : units) {
 		if (x->to_die) {
 			die_event_at(audio_orders, x);
 			x->to_die = false;
@@ -318,11 +324,35 @@ void Board::update(audio::Orders& audio_orders, double dt) noexcept {
 	units.remove_all([](auto& x) { return x.to_remove; });
 	towers.remove_all([](auto& x) { return x.to_remove; });
 
-	for (auto& x : proj_to_add) projectiles.push_back(x); proj_to_add.clear();
-	for (auto& x : unit_to_add) units.push_back(x); unit_to_add.clear();
+	for (auto& x : proj_to_add) projectiles.push_back(x); proj_to_add = {};
 	}
 }
 
+void Board::simulate(double seconds, double step) noexcept {
+	// Nothing gets pushed in there with presentation off, it's only to satisfy update.
+	thread_local audio::Orders muted_audio;
+
+	auto old_presentation = presentation;
+	auto old_view = view;
+	presentation = false;
+	view = std::nullopt;
+
+	// The whole run is one frame of the caller, its steps get an arena of their own and their
+	// samples all go in the caller's frame.
+	xstd::Nested_Frame_Arena steps;
+
+	Ressources gained = {};
+	for (double t = 0; t < seconds; t += step) {
+		update(muted_audio, std::min(step, seconds - t));
+		gained = add(gained, ressources_gained);
+		steps.arena.reset();
+	}
+
+	ressources_gained = gained;
+	presentation = old_presentation;
+	view = old_view;
+}
+
 void Board::render(render::Orders& order) noexcept {
 	render::Particle particle;
 	render::Circle circle;
@@ -382,18 +412,19 @@ void Board::render(render::Orders& order) noexcept {
 	m.object_blur = false;
 	m.dir = {1, 0, 0};
 
-	thread_local xstd::unordered_map<size_t, xstd::vector<render::Model>> models_by_object;
-	for (auto& [_, x] : models_by_object) x.clear();
+	// The keys are kept from one frame to the next, the models are in the frame arena.
+	thread_local xstd::swiss_map<size_t, xstd::frame_vector<render::Model>> models_by_object;
+	for (auto& [_, x] : models_by_object) x = {};
 
 	for (auto& x : units) {
 		m.object_blur = true;
 		m.object_id = x->object_id;
 		m.pos.x = x->pos.x + pos.x;
 		m.pos.y = x->pos.y + pos.y;
-		m.pos.z = std::sinf(x->life_time) * 0.1f + 0.3f;
+		m.pos.z = std::sin(x->life_time) * 0.1f + 0.3f;
 		m.last_pos.x = x->last_pos.x + pos.x;
 		m.last_pos.y = x->last_pos.y + pos.y;
-		m.last_pos.z = std::sinf(x->life_time) * 0.1f + 0.3f;
+		m.last_pos.z = std::sin(x->life_time) * 0.1f + 0.3f;
 		m.scale = 1;
 		m.last_scale = m.scale;
 		m.last_dir = m.dir;
@@ -429,10 +460,10 @@ void Board::render(render::Orders& order) noexcept {
 
 	m.origin = {0.5f, 0.5f, 0.0f};
 
-	thread_local xstd::unordered_map<
-		size_t, xstd::small_vector<render::World_Sprite, 16>
+	thread_local xstd::swiss_map<
+		size_t, xstd::frame_vector<render::World_Sprite>
 	> world_sprite_batches;
-	world_sprite_batches.clear();
+	for (auto& [_, x] : world_sprite_batches) x = {};
 	for (auto& x : towers) {
 		auto plane_pos = tile_box(x->tile_pos, x->tile_size).center() + pos;
 
@@ -603,6 +634,7 @@ void Board::compute_paths() noexcept {
 			path.closed[t] = true;
 		}
 	}
+	PROFILER_COUNTER_ADD("path nodes expanded", path.open_idx);
 
 	path.dirty = false;
 	return;
@@ -618,6 +650,7 @@ void Board::soft_compute_paths() noexcept {
 	auto it = path.open[path.open_idx++];
 	auto x = it / size.y;
 	auto y = it % size.y;
+	PROFILER_COUNTER_ADD("path nodes expanded", 1);
 
 	for (auto off : neighbors_list) if (
 		0 <= x + off.x && x + off.x < size.x && 0 <= y + off.y && y + off.y < size.y
@@ -636,6 +669,62 @@ void Board::soft_compute_paths() noexcept {
 	return;
 }
 
+dyn_struct Board::snapshot() const noexcept {
+	dyn_struct result = dyn_struct::structure_t{};
+	result["seconds_elapsed"] = seconds_elapsed;
+	result["size"] = size;
+	result["crowd_simulation"] = crowd_simulation;
+	result["presentation"] = presentation;
+
+	dyn_struct& path = result["path"] = dyn_struct::structure_t{};
+	path["dirty"] = path_construction.dirty;
+	path["soft_dirty"] = path_construction.soft_dirty;
+	path["open_idx"] = path_construction.open_idx;
+	path["open"] = path_construction.open.size();
+
+	result["towers"] = dyn_struct::array_t{};
+	for (auto& x : towers) {
+		dyn_struct t = dyn_struct::structure_t{};
+		t["kind"] = x.name();
+		t["tile_pos"] = x->tile_pos;
+		t["kill_count"] = x->kill_count;
+		t["attack_cd"] = x->attack_cd;
+		t["effects"] = x->effects.size;
+		result["towers"].push_back(t);
+	}
+
+	result["units"] = dyn_struct::array_t{};
+	for (auto& x : units) {
+		dyn_struct u = dyn_struct::structure_t{};
+		u["id"] = x.id;
+		u["kind"] = x.name();
+		u["pos"] = x->pos;
+		u["health"] = x->health;
+		u["current_tile"] = x->current_tile;
+		u["to_remove"] = x.to_remove;
+		result["units"].push_back(u);
+	}
+
+	size_t projectiles_by_kind[Projectile::Count] = {};
+	for (auto& x : projectiles) projectiles_by_kind[x.kind]++;
+	result["projectiles"] = dyn_struct::structure_t{};
+	for (size_t i = 1; i < Projectile::Count; ++i) if (projectiles_by_kind[i]) {
+		result["projectiles"][Projectile((Projectile::Kind)i).name()] = projectiles_by_kind[i];
+	}
+
+	result["crowd"] = dyn_struct::array_t{};
+	for (auto& x : crowd) {
+		dyn_struct c = dyn_struct::structure_t{};
+		c["tile"] = x.tile;
+		c["kind"] = Unit(x.kind).name();
+		c["count"] = x.count;
+		c["progress"] = x.progress;
+		result["crowd"].push_back(c);
+	}
+
+	return result;
+}
+
 std::optional<Vector2u> Board::get_tile_at(Vector2f x) noexcept {
 	auto s = tile_size + tile_padding;
 	if (pos.x - size.x * s / 2 < x.x && x.x < pos.x + size.x * s / 2)
@@ -706,6 +795,10 @@ void Board::spawn_unit(Unit u) noexcept {
 	size_t final = size.x * size.y;
 
 	size_t t = (size_t)(first + xstd::random() * (final - first));
+	if (crowd_simulation && t < hot_tiles.size() && !hot_tiles[t] && can_crowd(u)) {
+		crowd_add(t, u.kind, 1, 0);
+		return;
+	}
 	spawn_unit_at(u, t);
 }
 void Board::spawn_unit_at(Unit u, Vector2u tile) noexcept {
@@ -717,7 +810,7 @@ void Board::spawn_unit_at(Unit u, Vector2u tile) noexcept {
 	u->pos.y = rec.y + xstd::random() * rec.h;
 	u->last_pos = u->pos;
 
-	unit_to_add.push_back(u);
+	unit_enter_tile(units.push_back(u));
 }
 
 bool Board::can_place_at(Rectangleu zone) noexcept {
@@ -737,15 +830,15 @@ Rectanglef Board::tower_box(const Tower& tower) noexcept {
 	rec.pos = pos;
 	rec.x -= (size.x - 1) * bounding_tile_size() / 2.f;
 	rec.y -= (size.y - 1) * bounding_tile_size() / 2.f;
-	rec.x += tower->tile_rec.x * bounding_tile_size();
-	rec.y += tower->tile_rec.y * bounding_tile_size();
-	rec.w = tower->tile_rec.w * bounding_tile_size();
-	rec.h = tower->tile_rec.h * bounding_tile_size();
+	rec.x += tower->tile_pos.x * bounding_tile_size();
+	rec.y += tower->tile_pos.y * bounding_tile_size();
+	rec.w = tower->tile_size.x * bounding_tile_size();
+	rec.h = tower->tile_size.y * bounding_tile_size();
 	return rec;
 }
 
 void Board::pick_new_target(Tower& tower) noexcept {
-	auto tower_pos = tile_box(tower->tile_rec).center();
+	auto tower_pos = tile_box(tower->tile_rec()).center();
 
 	size_t* target_id_ptr = nullptr;
 	Tower_Target::Target_Mode mode;
@@ -814,23 +907,298 @@ void Board::pick_new_target(Tower& tower) noexcept {
 }
 
 void Board::unit_spatial_partition() noexcept {
-	unit_id_by_tile.resize(size.x * size.y);
 	unit_idx_by_tile.resize(size.x * size.y);
-	for (auto& x : unit_id_by_tile) x.clear();
-	for (auto& x : unit_id_by_tile) x.reserve(1000);
 	for (auto& x : unit_idx_by_tile) x.clear();
-	for (auto& x : unit_idx_by_tile) x.reserve(1000);
 
-	for (size_t i = 0; i < units.size(); ++i) {
+	for (size_t i = 0; i < units.slot_count(); ++i) if (units.occupied(i)) {
 		auto& x = units[i];
-		if (x->current_tile < unit_id_by_tile.size()) {
-			unit_id_by_tile[x->current_tile].push_back(x.id);
+		if (x->current_tile < unit_idx_by_tile.size()) {
 			unit_idx_by_tile[x->current_tile].push_back(i);
 		}
 	}
 }
 
+void Board::unit_enter_tile(const Unit& u) noexcept {
+	if (u->current_tile >= size.x * size.y) return;
+	unit_kind_count_by_tile[u->current_tile * Unit::Count + u.kind]++;
+}
+void Board::unit_leave_tile(const Unit& u) noexcept {
+	if (u->current_tile >= size.x * size.y) return;
+	unit_kind_count_by_tile[u->current_tile * Unit::Count + u.kind]--;
+}
+
+static const Unit& unit_prototype(Unit::Kind kind) noexcept {
+	static xstd::vector<Unit> prototypes = [] {
+		xstd::vector<Unit> v;
+		for (size_t i = 0; i < Unit::Count; ++i) v.push_back(Unit((Unit::Kind)i));
+		return v;
+	}();
+	return prototypes[kind];
+}
+
+// Needs to give the same result everywhere, xstd::hash_op is the identity on the web.
+static float crowd_jitter(uint64_t seed, uint64_t i) noexcept {
+	uint64_t x = seed * 0x9e3779b97f4a7c15ull + i;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	x = x ^ (x >> 31);
+	return (x >> 40) / (float)(1ull << 24);
+}
+
+void Board::mark_hot(Vector2f min, Vector2f max) noexcept {
+	if (size.x == 0 || size.y == 0) return;
+
+	auto to_tile = [&](float v, size_t n) {
+		auto i = (int64_t)std::floor(v / bounding_tile_size() + n / 2.f - 0.5f);
+		return (size_t)std::clamp<int64_t>(i, 0, (int64_t)n - 1);
+	};
+
+	for (size_t x = to_tile(min.x, size.x); x <= to_tile(max.x, size.x); ++x)
+	for (size_t y = to_tile(min.y, size.y); y <= to_tile(max.y, size.y); ++y)
+		hot_tiles[vec_to_idx({x, y})] = true;
+}
+
+void Board::compute_hot_tiles(double dt) noexcept {
+	hot_tiles.clear();
+	hot_tiles.resize(size.x * size.y, false);
+
+	// A tile of slack so units are materialized before they can be reached.
+	float margin = bounding_tile_size();
+
+	// >ADD_TOWER(Tackwin):
+	for (auto& t : towers) {
+		float r = 0;
+		t.on_one_off(TOWER_TARGET_LIST, Sharp) (auto& x) { r = x.range; };
+		if (r > 0) mark_hot(tower_box(t).center(), r + margin);
+	}
+
+	for (auto& p : projectiles) {
+		mark_hot(p->pos, p->r + p->speed * dt + margin);
+
+		p.on_one_off(PROJ_SEEK_LIST) (auto& x) {
+			if (units.exist(x.to)) mark_hot(units.id(x.to)->pos, margin);
+		};
+		p.on_one_off(PROJ_TARGET_LIST) (auto& x) {
+			mark_hot(x.target, x.r + margin);
+		};
+	}
+
+	if (view) mark_hot(view->pos - pos - margin, view->pos + view->size - pos + margin);
+}
+
+bool Board::can_crowd(const Unit& u) noexcept {
+	// A packet only knows its kind, anything that drifted from the defaults stays a unit.
+	auto& proto = unit_prototype(u.kind);
+	return u->health == proto->health && u->speed == proto->speed && u->invincible <= 0;
+}
+
+void Board::crowd_add(size_t tile, Unit::Kind kind, size_t count, float progress) noexcept {
+	Crowd_Packet p;
+	p.tile = tile;
+	p.kind = kind;
+	p.count = count;
+	p.progress = progress;
+	p.seed = crowd_next_seed++;
+	crowd_insert(p);
+}
+
+void Board::crowd_insert(const Crowd_Packet& p) noexcept {
+	auto bin = (size_t)(p.progress / bounding_tile_size() * Crowd_Bins);
+	bin = std::min(bin, Crowd_Bins - 1);
+
+	size_t slot = (p.tile * Unit::Count + p.kind) * Crowd_Bins + bin;
+	if (crowd_slots.contains(slot)) {
+		crowd[crowd_slots.at(slot)].count += p.count;
+		return;
+	}
+
+	crowd_slots[slot] = crowd.size();
+	crowd.push_back(p);
+}
+
+void Board::crowd_update(double dt) noexcept {
+	crowd_swap.clear();
+	std::swap(crowd, crowd_swap);
+	crowd_slots.clear();
+
+	for (auto& p : crowd_swap) {
+		// Paths are computed at the top of update, they cover every tile by now. Skipping the
+		// packet would lose its units and crowd_size would still have counted them.
+		assert(p.tile < next_tile.size());
+		p.progress += unit_prototype(p.kind)->speed * dt;
+
+		bool exited = false;
+		while (!hot_tiles[p.tile]) {
+			auto next = next_tile[p.tile];
+			if (next == SIZE_MAX) {
+				p.progress = 0;
+				break;
+			}
+
+			auto len = (tile_box(next).center() - tile_box(p.tile).center()).length();
+			if (p.progress < len) break;
+
+			p.progress -= len;
+			p.tile = next;
+			if (p.tile < size.y) {
+				exited = true;
+				break;
+			}
+		}
+
+		if (exited) continue;
+		if (hot_tiles[p.tile]) crowd_materialize(p);
+		else                   crowd_insert(p);
+	}
+}
+
+void Board::crowd_materialize(const Crowd_Packet& p) noexcept {
+	auto from = tile_box(p.tile).center();
+	auto next = next_tile[p.tile];
+
+	Vector2f along = {};
+	if (next != SIZE_MAX && next != p.tile) {
+		auto to = tile_box(next).center();
+		along = (to - from).normed() * std::min(p.progress, (to - from).length());
+	}
+
+	for (size_t i = 0; i < p.count; ++i) {
+		Unit u(p.kind);
+		u->current_tile = p.tile;
+		u->pos = from + along;
+		u->pos.x += (crowd_jitter(p.seed, 2 * i + 0) - 0.5f) * bounding_tile_size();
+		u->pos.y += (crowd_jitter(p.seed, 2 * i + 1) - 0.5f) * bounding_tile_size();
+		u->last_pos = u->pos;
+
+		unit_enter_tile(units.push_back(u));
+	}
+}
+
+void Board::crowd_demote() noexcept {
+	if (!crowd_simulation) return;
+
+	for (auto& x : units) if (!x.to_remove && can_crowd(x)) {
+		auto tile = x->current_tile;
+		if (tile >= hot_tiles.size() || tile >= next_tile.size()) continue;
+
+		// The whole neighborhood has to be cold, otherwise units on the edge of a range would
+		// go back and forth every frame.
+		bool cold = true;
+		auto t = idx_to_vec(tile);
+		for (int off_x = -1; off_x <= 1; ++off_x) for (int off_y = -1; off_y <= 1; ++off_y)
+		if (size.x > t.x + off_x && size.y > t.y + off_y) {
+			cold &= !hot_tiles[vec_to_idx({t.x + off_x, t.y + off_y})];
+		}
+		if (!cold) continue;
+
+		float progress = 0;
+		auto next = next_tile[tile];
+		if (next != SIZE_MAX && next != tile) {
+			auto from = tile_box(tile).center();
+			auto dir = (tile_box(next).center() - from).normed();
+			progress = std::max(0.f, (x->pos - from).dot(dir));
+		}
+
+		unit_leave_tile(x);
+		x.to_remove = true;
+		crowd_add(tile, x.kind, 1, progress);
+	}
+}
+
+size_t Board::crowd_size() const noexcept {
+	size_t n = 0;
+	for (auto& x : crowd) n += x.count;
+	return n;
+}
+
+std::optional<Board::Sweep_Hit> Board::sweep_units(Vector2f a, Vector2f b, float r) noexcept {
+	std::optional<Sweep_Hit> hit;
+
+	// Same tile mapping as the 3x3 lookups, but kept continuous so we can walk it.
+	auto to_grid = [&](Vector2f p) {
+		return (p + Vector2f{size.x / 2.f, size.y / 2.f} * bounding_tile_size()) /
+			bounding_tile_size();
+	};
+	auto ga = to_grid(a);
+	auto gb = to_grid(b);
+	auto d  = gb - ga;
+
+	int64_t cx = (int64_t)std::floor(ga.x);
+	int64_t cy = (int64_t)std::floor(ga.y);
+	int64_t ex = (int64_t)std::floor(gb.x);
+	int64_t ey = (int64_t)std::floor(gb.y);
+
+	int64_t step_x = d.x > 0 ? 1 : -1;
+	int64_t step_y = d.y > 0 ? 1 : -1;
+	float t_delta_x = d.x != 0 ? std::abs(1 / d.x) : FLT_MAX;
+	float t_delta_y = d.y != 0 ? std::abs(1 / d.y) : FLT_MAX;
+	float t_max_x = FLT_MAX;
+	float t_max_y = FLT_MAX;
+	if (d.x > 0) t_max_x = (cx + 1 - ga.x) / d.x;
+	if (d.x < 0) t_max_x = (ga.x - cx) / -d.x;
+	if (d.y > 0) t_max_y = (cy + 1 - ga.y) / d.y;
+	if (d.y < 0) t_max_y = (ga.y - cy) / -d.y;
+
+	auto test_tile = [&](int64_t x, int64_t y) {
+		if (x < 0 || y < 0 || x >= (int64_t)size.x || y >= (int64_t)size.y) return;
+
+		for (auto& u_idx : unit_idx_by_tile[vec_to_idx({(size_t)x, (size_t)y})]) {
+			auto& u = units[u_idx];
+			if (u.to_remove) continue;
+
+			// In the unit frame the projectile goes from p to p + v over the step.
+			auto p = a - u->last_pos;
+			auto v = (b - u->pos) - p;
+			auto c = p.length2() - r * r;
+
+			float t = 0;
+			if (c > 0) {
+				auto vv = v.length2();
+				auto pv = p.dot(v);
+				if (pv >= 0 || vv == 0) continue;
+
+				auto disc = pv * pv - vv * c;
+				if (disc < 0) continue;
+
+				t = (-pv - std::sqrt(disc)) / vv;
+				if (t > 1) continue;
+			}
+
+			if (!hit || t < hit->t) hit = Sweep_Hit{ u.id, t };
+		}
+	};
+
+	// Every walked tile checks its 3x3 neighborhood like the discrete test did, the path is
+	// monotone so we only need to skip what the previous tile already covered.
+	size_t n_steps = (size_t)(std::abs(ex - cx) + std::abs(ey - cy));
+	int64_t px = cx;
+	int64_t py = cy;
+	for (size_t i = 0; i <= n_steps; ++i) {
+		for (int64_t off_x = -1; off_x <= 1; ++off_x)
+		for (int64_t off_y = -1; off_y <= 1; ++off_y) {
+			auto x = cx + off_x;
+			auto y = cy + off_y;
+			if (i > 0 && std::abs(x - px) <= 1 && std::abs(y - py) <= 1) continue;
+			test_tile(x, y);
+		}
+
+		px = cx;
+		py = cy;
+		if (t_max_x < t_max_y) {
+			cx += step_x;
+			t_max_x += t_delta_x;
+		} else {
+			cy += step_y;
+			t_max_y += t_delta_y;
+		}
+	}
+
+	return hit;
+}
+
 void Board::hit_event_at(Vector3f pos, const Projectile& proj) noexcept {
+	if (!presentation) return;
+
 	Particle_Effect d;
 	d.pos = pos;
 	d.color = V4F(1);
@@ -856,47 +1224,44 @@ void Board::hit_event_at(Vector3f pos, const Projectile& proj) noexcept {
 }
 
 void Board::die_event_at(audio::Orders& audio_orders, Unit& u) noexcept {
-	Particle_Effect d;
-	d.pos = Vector3f(u->pos, 0.5f);
-	effects.push_back(d);
+	if (presentation) {
+		Particle_Effect d;
+		d.pos = Vector3f(u->pos, 0.5f);
+		effects.push_back(d);
+	}
 
-	ressources_gained = add(ressources_gained, u->get_drop());
+	auto& info = unit_info(u.kind);
+	ressources_gained = add(ressources_gained, info.drop);
 
-	u.on_one_off(UNIT_SPLIT) (auto& x) {
-		auto n = x.split_n;
-		auto pos = x.pos;
-		auto tile = idx_to_vec(x.current_tile);
-		for (size_t i = 0; i < n; ++i) {
-			typename TYPE(x)::split_to spawned;
+	if (info.split_to != Unit::None_Kind) {
+		auto pos = u->pos;
+		auto tile = idx_to_vec(u->current_tile);
+		for (size_t i = 0; i < info.split_n; ++i) {
+			Unit spawned(info.split_to);
 
-			spawned.pos = pos;
-			spawn_unit_at(spawned, tile); // this push to the pool so it might invalidate x.
+			spawned->pos = pos;
+			spawn_unit_at(spawned, tile);
 		}
-	};
+	}
 
 	u.on_one_off(UNIT_DIE_CATALYST_MERGE) (auto& x) {
-		for_each_type(UNIT_MERGE) (auto tag) {
-			using T = typename decltype(tag)::type;
-			size_t n = 0;
-			for (auto& u : unit_id_by_tile[x.current_tile]) {
-				auto& y = units.id(u);
-				if (y.kind == Unit::MAP_type_kind<T>::kind && !y.to_remove && !y->to_die) {
-					n++;
-				}
-			}
+		for (size_t k = 1; k < Unit::Count; ++k) {
+			auto merge_to = unit_info((Unit::Kind)k).merge_to;
+			if (merge_to == Unit::None_Kind) continue;
 
+			size_t n = unit_kind_count(x.current_tile, (Unit::Kind)k);
 			for (size_t i = 0; i < n / 2; ++i) {
-				Merge_t<T> to_merge;
-				to_merge.pos = pos;
+				Unit to_merge(merge_to);
+				to_merge->pos = pos;
 
 				spawn_unit_at(to_merge, x.current_tile);
 			}
-		};
+		}
 	};
 
-	u.on_one_off(UNIT_DIE_CATALYST_MERGE) (auto& x) {
-		for (auto& u : unit_id_by_tile[x.current_tile]) {
-			auto& y = units.id(u);
+	u.on_one_off(UNIT_DIE_INVINCIBLE_BUFF) (auto& x) {
+		for (auto& u_idx : unit_idx_by_tile[x.current_tile]) {
+			auto& y = units[u_idx];
 			if (y.to_remove) continue;
 			y->invincible = std::max(1.f, y->invincible + 1.f);
 		}
@@ -974,3 +1339,20 @@ Projectile Board::get_projectile(Tower& from, Unit& target) noexcept {
 		default: return {};
 	}
 }
+
+void set_entity_gauges(std::span<const Board> boards) noexcept {
+	size_t units = 0;
+	size_t projectiles = 0;
+	size_t towers = 0;
+	size_t crowd = 0;
+	for (auto& x : boards) {
+		units += x.units.size();
+		projectiles += x.projectiles.size();
+		towers += x.towers.size();
+		crowd += x.crowd.size();
+	}
+	PROFILER_GAUGE_SET("live units", units);
+	PROFILER_GAUGE_SET("live projectiles", projectiles);
+	PROFILER_GAUGE_SET("live towers", towers);
+	PROFILER_GAUGE_SET("crowd packets", crowd);
+}
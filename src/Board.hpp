@@ -1,10 +1,12 @@
 #pragma once 
 
 #include <optional>
+#include <span>
 #include <unordered_set>
 #include <float.h>
 
 #include "std/vector.hpp"
+#include "std/unordered_map.hpp"
 #include "std/bloom_filter.hpp"
 
 #include "dyn_struct.hpp"
@@ -41,6 +43,7 @@ struct Tile {
 	sum_type_base(Common_Tile);
 	size_t id = 0;
 };
+XSTD_TRIVIALLY_RELOCATABLE(Tile);
 
 struct Base_Projectile {
 	Vector2f pos;
@@ -123,7 +126,7 @@ struct Circuit_Projectile : Base_Projectile {
 // hit behavior
 #define PROJ_SPLASH_LIST Splash_Projectile
 #define PROJ_SPLIT_LIST Split_Projectile
-#define PROJ_SIMPLE_HIT_LIST Seek_Projectile, Split_Projectile
+#define PROJ_SIMPLE_HIT_LIST Seek_Projectile, Straight_Projectile, Split_Projectile
 #define PROJ_GO_NEXT_LIST Circuit_Projectile
 
 #define PROJ_LIST(X)\
@@ -136,6 +139,7 @@ struct Projectile {
 	size_t id = 0;
 	bool to_remove = false;
 };
+XSTD_TRIVIALLY_RELOCATABLE(Projectile);
 
 struct Board {
 	struct Gui {
@@ -153,12 +157,13 @@ struct Board {
 	size_t cease_zone_width = 2;
 
 	xstd::Pool<Tile> tiles;
-	xstd::Pool<Unit> units;
-	xstd::Pool<Tower> towers;
+	// Stable, a Unit& or Tower& is good until the element is removed at the end of update.
+	xstd::Stable_Pool<Unit> units;
+	xstd::Stable_Pool<Tower> towers;
 	xstd::Pool<Projectile> projectiles;
 
-	xstd::vector<Unit> unit_to_add;
-	xstd::vector<Projectile> proj_to_add;
+	// Filled and emptied within the frame, see xstd::frame_vector.
+	xstd::frame_vector<Projectile> proj_to_add;
 
 	struct Particle_Effect {
 		Vector3f pos;
@@ -168,8 +173,35 @@ struct Board {
 	};
 	xstd::vector<Particle_Effect> effects;
 
-	xstd::vector<xstd::vector<size_t>> unit_id_by_tile;
 	xstd::vector<xstd::vector<size_t>> unit_idx_by_tile;
+	// Alive units by tile and kind, [tile * Unit::Count + kind]. Kept up to date as units
+	// change tile, get removed or get added, so no need to walk the tile to count them.
+	xstd::vector<size_t> unit_kind_count_by_tile;
+
+	// Units that no tower can reach and no camera can see are moved as packets of the same
+	// kind along next_tile instead of one by one. A packet is turned back into units, always
+	// at the same positions for the same packet, as soon as its tile gets hot.
+	struct Crowd_Packet {
+		size_t tile = 0;
+		Unit::Kind kind = Unit::None_Kind;
+		size_t count = 0;
+		float progress = 0;
+		uint64_t seed = 0;
+	};
+	static constexpr size_t Crowd_Bins = 4;
+	bool crowd_simulation = true;
+
+	// Off means update skips everything that is only there to be seen or heard: particles,
+	// tile tints and sounds. The simulation itself is the same.
+	bool presentation = true;
+	xstd::vector<Crowd_Packet> crowd;
+	xstd::vector<Crowd_Packet> crowd_swap;
+	xstd::unordered_map<size_t, size_t> crowd_slots;
+	uint64_t crowd_next_seed = 1;
+	xstd::vector<bool> hot_tiles;
+
+	// World space rectangle seen by the camera, units in there are always materialized.
+	std::optional<Rectanglef> view;
 
 	xstd::vector<size_t> next_tile;
 	xstd::vector<size_t> dist_tile;
@@ -189,12 +221,37 @@ struct Board {
 	void update(audio::Orders& audio_orders, double dt) noexcept;
 	void render(render::Orders& orders) noexcept;
 
+	// Fast forward seconds of game time in steps of step, without presentation. What was
+	// gained over the whole run is left in ressources_gained. It's all one frame for the
+	// sample log and the frame arena of the caller.
+	void simulate(double seconds, double step) noexcept;
+
+	// What's on the board, for a human to read after the fact, see Profiler/Frame_Watchdog.
+	// Not meant to be loaded back.
+	dyn_struct snapshot() const noexcept;
+
 	Rectanglef tile_box(Rectangleu rec) noexcept { return tile_box(rec.pos, rec.size); }
 	Rectanglef tile_box(Vector2u pos, Vector2u size = {1, 1}) noexcept;
 	Rectanglef tile_box(size_t idx) noexcept { return tile_box(idx_to_vec(idx)); }
 	Rectanglef tower_box(const Tower& tower) noexcept;
 
 	void unit_spatial_partition() noexcept;
+	void unit_enter_tile(const Unit& u) noexcept;
+
+	void mark_hot(Vector2f min, Vector2f max) noexcept;
+	void mark_hot(Vector2f p, float r) noexcept { mark_hot(p - Vector2f{r, r}, p + Vector2f{r, r}); }
+	void compute_hot_tiles(double dt) noexcept;
+	bool can_crowd(const Unit& u) noexcept;
+	void crowd_add(size_t tile, Unit::Kind kind, size_t count, float progress) noexcept;
+	void crowd_insert(const Crowd_Packet& p) noexcept;
+	void crowd_update(double dt) noexcept;
+	void crowd_materialize(const Crowd_Packet& p) noexcept;
+	void crowd_demote() noexcept;
+	size_t crowd_size() const noexcept;
+	void unit_leave_tile(const Unit& u) noexcept;
+	size_t unit_kind_count(size_t tile, Unit::Kind kind) const noexcept {
+		return unit_kind_count_by_tile[tile * Unit::Count + kind];
+	}
 
 	void soft_compute_paths() noexcept;
 	void compute_paths() noexcept;
@@ -202,6 +259,13 @@ struct Board {
 
 	std::optional<Vector2u> get_tile_at(Vector2f x) noexcept;
 
+	struct Sweep_Hit {
+		size_t unit_id = 0;
+		float t = 0;
+	};
+	// Earliest unit touched by a circle of radius r going from a to b during this step.
+	std::optional<Sweep_Hit> sweep_units(Vector2f a, Vector2f b, float r) noexcept;
+
 	void insert_tower(Tower t) noexcept;
 	void remove_tower(Vector2u p) noexcept;
 	void remove_tower(Tower& p) noexcept;
@@ -228,4 +292,8 @@ struct Board {
 	bool is_valid_target(const Tower& t, const Unit& u) noexcept;
 
 	Projectile get_projectile(Tower& from, Unit& target) noexcept;
-};
\ No newline at end of file
+};
+
+// The live units, projectiles, towers and crowd packets gauges, summed over every board. Once a
+// frame after they all updated, one board setting them would hide the others.
+extern void set_entity_gauges(std::span<const Board> boards) noexcept;
@@ -21,6 +21,7 @@ struct Effect {
 	sum_type(Effect, EFFECT_LIST);
 	sum_type_base(Effect_Base);
 };
+XSTD_TRIVIALLY_RELOCATABLE(Effect);
 
 struct Tower;
 extern void apply_effects(Tower& tower, xstd::span<Effect> effects) noexcept;
@@ -59,6 +59,8 @@ void loop() noexcept {
 	game_proc.render(game, render_orders);
 
 	render::render_orders(render_orders, render_param);
+	render_orders.clear();
+	xstd::frame_arena().reset();
 }
 
 bool init_gl_context() noexcept {
@@ -0,0 +1,444 @@
+#include <new>
+#include <optional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "Audio/Audio.hpp"
+#include "Profiler/Allocations.hpp"
+#include "Profiler/Sampling_Profiler.hpp"
+#include "Profiler/Tracer.hpp"
+#include "xstd.hpp"
+
+#include "Bench/Checks.hpp"
+#include "Bench/Micro_Bench.hpp"
+#include "Bench/Regression_Gate.hpp"
+#include "Bench/Scenario.hpp"
+#include "Board.hpp"
+#include "Graphic/Mesh_Cache.hpp"
+#include "Wave.hpp"
+
+// Audio.cpp points the device at it, there's never a device here.
+void sound_callback(ma_device*, void*, const void*, ma_uint32) {}
+
+// No window, no rendering and no sound, only boards being updated. Compares the normal update
+// loop with Board::simulate on the same board, same wave and same seed.
+// With --bench <name|all> runs the named scenarios instead and writes their report to --out,
+// each one --runs times, the profiles below are of the first run. --baseline gates it against
+// an older report like --gate does. --trace <dir> records a trace session of the run in dir, and
+// --convert-trace <in.ltwtrace> <out.json> turns such a trace into a Chrome trace.
+// --watchdog <dir> writes a Chrome trace and a snapshot of the board in dir every time a frame
+// of a scenario goes over --budget-ms.
+// --gate <before.json> <now.json> compares the runs of two --bench reports and fails if any
+// number got larger by more than --tolerance and its noise, at --alpha, see
+// Bench/Regression_Gate.hpp. Five runs a side or more, with one it's only the tolerance.
+// --noise <again.json>, another report of the build before, made apart from it, adds how much
+// the machine drifts between two invocations to the noise.
+// --profile <dir> writes the call tree of each scenario with percentiles over the last
+// --profile-window frames each node ran in, as <dir>/<scenario>.csv and .json.
+// --alloc-profile <dir> tracks who allocates in each scenario, per TIMED_BLOCK scope and call
+// site, as <dir>/<scenario>.allocations.json.
+// --sample-profile <dir> samples the call stacks of each scenario --sample-hz times a second,
+// Linux only, as <dir>/<scenario>.folded for flamegraph.pl or speedscope.
+// --micro <group|all> runs the container microbenchmarks of Bench/Micro_Bench.hpp instead,
+// and writes their results to --out if it's given.
+// --check <name|all> runs the deterministic checks of Bench/Checks.hpp and fails if any does.
+// --sizes prints how big each kind of the sum types is and which are boxed.
+// --cook <dir> cooks every .ply in dir into its .mesh cache, see Graphic/Mesh_Cache.hpp, and
+// prints what it changed.
+
+struct Headless_Options {
+	size_t wave = 20;
+	size_t seed = 0;
+	double seconds = 60;
+	double step = 1 / 60.0;
+
+	const char* bench = nullptr;
+	const char* out = nullptr;
+	const char* baseline = nullptr;
+	double tolerance = 0.1;
+	size_t runs = 1;
+	std::optional<double> bench_seconds;
+
+	const char* trace = nullptr;
+	const char* profile = nullptr;
+	size_t profile_window = 600;
+	const char* alloc_profile = nullptr;
+	const char* sample_profile = nullptr;
+	size_t sample_hz = 1000;
+	const char* watchdog = nullptr;
+	double budget_ms = 1000 / 60.0;
+	const char* convert_from = nullptr;
+	const char* convert_to = nullptr;
+
+	const char* gate_before = nullptr;
+	const char* gate_now = nullptr;
+	const char* noise = nullptr;
+	double alpha = 0.01;
+
+	const char* micro = nullptr;
+	const char* check = nullptr;
+	bool sizes = false;
+	const char* cook = nullptr;
+};
+
+// Every allocation goes through here so the scenarios can report how much they allocate. The
+// size, and the scope it is tracked in, are kept in front of the block for when it's freed.
+struct Allocation_Header {
+	size_t n;
+	std::uint32_t scope;
+};
+static constexpr size_t Allocation_Header_Size = alignof(std::max_align_t);
+static_assert(sizeof(Allocation_Header) <= Allocation_Header_Size);
+
+static void* allocate(size_t n, void* caller) {
+	auto p = (char*)malloc(n + Allocation_Header_Size);
+	if (!p) throw std::bad_alloc{};
+	allocation_counters.on_alloc(n);
+	*(Allocation_Header*)p = { n, track_allocation(n, caller) };
+	return p + Allocation_Header_Size;
+}
+void* operator new(size_t n) { return allocate(n, ALLOCATION_CALLER()); }
+void* operator new[](size_t n) { return allocate(n, ALLOCATION_CALLER()); }
+
+void operator delete(void* p) noexcept {
+	if (!p) return;
+	auto block = (char*)p - Allocation_Header_Size;
+	auto header = *(Allocation_Header*)block;
+	allocation_counters.on_free(header.n);
+	track_free(header.scope, header.n);
+	free(block);
+}
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+Headless_Options parse_options(int argc, char** argv) noexcept {
+	Headless_Options opts;
+
+	for (int i = 1; i + 1 < argc; ++i) {
+		if (strcmp(argv[i], "--wave") == 0)    opts.wave    = strtoull(argv[++i], nullptr, 10);
+		if (strcmp(argv[i], "--seed") == 0)    opts.seed    = strtoull(argv[++i], nullptr, 10);
+		if (strcmp(argv[i], "--seconds") == 0) {
+			opts.seconds = strtod(argv[++i], nullptr);
+			opts.bench_seconds = opts.seconds;
+		}
+		if (strcmp(argv[i], "--step") == 0)    opts.step    = strtod(argv[++i], nullptr);
+		if (strcmp(argv[i], "--bench") == 0)     opts.bench     = argv[++i];
+		if (strcmp(argv[i], "--out") == 0)       opts.out       = argv[++i];
+		if (strcmp(argv[i], "--baseline") == 0)  opts.baseline  = argv[++i];
+		if (strcmp(argv[i], "--tolerance") == 0) opts.tolerance = strtod(argv[++i], nullptr);
+		if (strcmp(argv[i], "--runs") == 0)      opts.runs      = strtoull(argv[++i], nullptr, 10);
+		if (strcmp(argv[i], "--trace") == 0)     opts.trace     = argv[++i];
+		if (strcmp(argv[i], "--profile") == 0)   opts.profile   = argv[++i];
+		if (strcmp(argv[i], "--alloc-profile") == 0)  opts.alloc_profile  = argv[++i];
+		if (strcmp(argv[i], "--sample-profile") == 0) opts.sample_profile = argv[++i];
+		if (strcmp(argv[i], "--watchdog") == 0)  opts.watchdog  = argv[++i];
+		if (strcmp(argv[i], "--budget-ms") == 0) opts.budget_ms = strtod(argv[++i], nullptr);
+		if (strcmp(argv[i], "--sample-hz") == 0)
+			opts.sample_hz = strtoull(argv[++i], nullptr, 10);
+		if (strcmp(argv[i], "--profile-window") == 0)
+			opts.profile_window = strtoull(argv[++i], nullptr, 10);
+		if (strcmp(argv[i], "--convert-trace") == 0 && i + 2 < argc) {
+			opts.convert_from = argv[++i];
+			opts.convert_to   = argv[++i];
+		}
+		if (strcmp(argv[i], "--gate") == 0 && i + 2 < argc) {
+			opts.gate_before = argv[++i];
+			opts.gate_now    = argv[++i];
+		}
+		if (strcmp(argv[i], "--alpha") == 0) opts.alpha = strtod(argv[++i], nullptr);
+		if (strcmp(argv[i], "--noise") == 0) opts.noise = argv[++i];
+		if (strcmp(argv[i], "--micro") == 0) opts.micro = argv[++i];
+		if (strcmp(argv[i], "--check") == 0) opts.check = argv[++i];
+		if (strcmp(argv[i], "--cook") == 0)  opts.cook  = argv[++i];
+	}
+	// The only one without a value, it can be last.
+	for (int i = 1; i < argc; ++i) if (strcmp(argv[i], "--sizes") == 0) opts.sizes = true;
+
+	return opts;
+}
+
+void setup_board(Board& board, const Headless_Options& opts) noexcept {
+	xstd::seed(opts.seed);
+	board.tiles.resize(board.size.x * board.size.y, Empty{});
+
+	for (size_t i = 0; i < 4; ++i) {
+		Tower t = Mirror{};
+		t->tile_pos = {10 + i * 10, board.size.y / 2 - 1};
+		if (board.can_place_at(t->tile_rec())) board.insert_tower(t);
+	}
+
+	board.current_wave = gen_wave(opts.wave);
+}
+
+// What --gate and --baseline share.
+int gate(const dyn_struct& before, const dyn_struct& now, const Headless_Options& opts) noexcept {
+	std::optional<dyn_struct> noise;
+	if (opts.noise && !(noise = load_from_json_file(opts.noise))) {
+		printf("Can't read %s\n", opts.noise);
+		return 2;
+	}
+
+	size_t regressions = regression_gate(
+		before, now, opts.tolerance, opts.alpha, noise ? &*noise : nullptr
+	);
+	if (regressions) printf("%zu regressions\n", regressions);
+	return regressions ? 1 : 0;
+}
+
+int run_bench(const Headless_Options& opts) noexcept {
+	dyn_struct report = dyn_struct::structure_t{};
+	report["scenarios"] = dyn_struct::array_t{};
+	xstd::vector<Scenario> ran;
+
+	for (auto& s : get_all_scenarios()) {
+		if (strcmp(opts.bench, "all") != 0 && strcmp(opts.bench, s.name) != 0) continue;
+
+		auto scenario = s;
+		scenario.seed = opts.seed;
+		scenario.step = opts.step;
+		if (opts.bench_seconds) scenario.seconds = *opts.bench_seconds;
+		ran.push_back(scenario);
+
+		Scoped_Timer timer(Trace_Category::Scope, Tracer::intern(s.name));
+		Profile_Tree profile(opts.profile_window);
+		if (opts.alloc_profile) {
+			reset_allocation_tracking();
+			allocation_tracking = true;
+		}
+		if (opts.sample_profile && !start_sampling(opts.sample_hz)) {
+			printf("Can't sample the call stacks on this platform\n");
+		}
+		Frame_Watchdog watchdog;
+		if (opts.watchdog) {
+			watchdog.enabled = true;
+			watchdog.budget_ms = opts.budget_ms;
+			watchdog.dir = std::filesystem::path(opts.watchdog) / s.name;
+		}
+		auto result = run_scenario(
+			scenario, opts.profile ? &profile : nullptr, opts.watchdog ? &watchdog : nullptr
+		);
+		allocation_tracking = false;
+
+		if (opts.sample_profile) {
+			std::filesystem::path dir = opts.sample_profile;
+			std::error_code ec;
+			std::filesystem::create_directories(dir, ec);
+			stop_sampling(dir / (std::string(s.name) + ".folded"));
+		}
+
+		if (opts.alloc_profile) {
+			std::filesystem::path dir = opts.alloc_profile;
+			std::error_code ec;
+			std::filesystem::create_directories(dir, ec);
+			save_to_json_file(
+				allocation_report(), dir / (std::string(s.name) + ".allocations.json")
+			);
+		}
+
+		if (opts.profile) {
+			std::filesystem::path dir = opts.profile;
+			std::error_code ec;
+			std::filesystem::create_directories(dir, ec);
+			profile.save_csv(dir / (std::string(s.name) + ".csv"));
+			save_to_json_file(profile.to_dyn_struct(), dir / (std::string(s.name) + ".json"));
+		}
+		printf(
+			"%-30s % 8zu frames, mean % 8.3lf ms, p95 % 8.3lf ms, max % 8.3lf ms\n",
+			s.name,
+			(size_t)result["frames"],
+			(double)result["frame_ms"]["mean"],
+			(double)result["frame_ms"]["p95"],
+			(double)result["frame_ms"]["max"]
+		);
+		report["scenarios"].push_back(result);
+	}
+
+	if (size(report["scenarios"]) == 0) {
+		printf("No scenario named %s, the scenarios are:\n", opts.bench);
+		for (auto& s : get_all_scenarios()) printf("  %s\n", s.name);
+		return 1;
+	}
+
+	// The other runs go round the scenarios, a slow stretch of the machine is spread over all
+	// of them instead of being every run of one.
+	for (size_t r = 1; r < opts.runs; ++r) for (size_t i = 0; i < ran.size(); ++i) {
+		auto again = run_scenario(ran[i]);
+		report["scenarios"][i]["runs"].push_back(again["runs"][(size_t)0]);
+	}
+
+	if (opts.out) save_to_json_file(report, opts.out);
+	else printf("%s\n", format_to_json(report).c_str());
+
+	if (!opts.baseline) return 0;
+
+	auto baseline = load_from_json_file(opts.baseline);
+	if (!baseline) {
+		printf("Can't read the baseline %s\n", opts.baseline);
+		return 1;
+	}
+
+	return gate(*baseline, report, opts);
+}
+
+int run_gate(const Headless_Options& opts) noexcept {
+	auto before = load_from_json_file(opts.gate_before);
+	auto now = load_from_json_file(opts.gate_now);
+	if (!before || !now) {
+		printf("Can't read %s\n", !before ? opts.gate_before : opts.gate_now);
+		return 2;
+	}
+	return gate(*before, *now, opts);
+}
+
+template<typename T>
+void print_sum_type_sizes(const char* name) noexcept {
+	printf("%-22s % 4zu bytes\n", name, sizeof(T));
+	for (size_t i = 1; i < T::Count; ++i) {
+		printf(
+			"  %-20s % 4zu%s%s\n",
+			T::Kind_Name[i],
+			T::Kind_Size[i],
+			T::Kind_Boxed((typename T::Kind)i) ? ", boxed" : "",
+			T::Kind_Trivial[i] ? ", trivially copyable" : ""
+		);
+	}
+}
+
+int run_check(const Headless_Options& opts) noexcept {
+	auto failed = run_checks(opts.check);
+	if (failed == SIZE_MAX) {
+		printf("No check named %s\n", opts.check);
+		return 1;
+	}
+	return failed ? 1 : 0;
+}
+
+int print_sizes() noexcept {
+	print_sum_type_sizes<Unit>("Unit");
+	print_sum_type_sizes<Tower>("Tower");
+	print_sum_type_sizes<Projectile>("Projectile");
+	print_sum_type_sizes<Tile>("Tile");
+	print_sum_type_sizes<Effect>("Effect");
+	print_sum_type_sizes<render::Order>("render::Order");
+	return 0;
+}
+
+int run_micro(const Headless_Options& opts) noexcept {
+	auto results = run_micro_bench(opts.micro);
+	if (results.empty()) {
+		printf("No microbenchmark group named %s\n", opts.micro);
+		return 1;
+	}
+	if (opts.out) save_to_json_file(micro_report(results), opts.out);
+	return 0;
+}
+
+int run_cook(const Headless_Options& opts) noexcept {
+	std::error_code ec;
+	size_t failed = 0;
+	for (auto& x : std::filesystem::directory_iterator(opts.cook, ec)) {
+		if (x.path().extension() != ".ply") continue;
+		auto name = x.path().filename().string();
+
+		// Not the layout the game's models are in, the game can't load it either.
+		auto obj = Object::load_from_file(x.path());
+		if (!obj) {
+			printf("%-24s skipped, can't be read\n", name.c_str());
+			continue;
+		}
+
+		auto vertices = obj->vertices.size();
+		auto acmr = mesh::acmr(*obj);
+		mesh::cook(*obj);
+		if (!mesh::write_cache(*obj, x.path(), mesh::cache_path(x.path()))) {
+			printf("%-24s can't be written\n", name.c_str());
+			failed++;
+			continue;
+		}
+
+		printf(
+			"%-24s vertices % 5zu -> % 5zu, acmr %.3lf -> %.3lf\n",
+			name.c_str(),
+			vertices,
+			obj->vertices.size(),
+			acmr,
+			mesh::acmr(*obj)
+		);
+	}
+	if (ec) printf("Can't read %s\n", opts.cook);
+	return failed || ec ? 1 : 0;
+}
+
+audio::Orders sound_orders;
+
+int main(int argc, char** argv) {
+	auto opts = parse_options(argc, argv);
+	if (opts.profile_window == 0) {
+		printf("--profile-window has to be at least 1 frame\n");
+		return 1;
+	}
+	if (opts.runs == 0) {
+		printf("--runs has to be at least 1\n");
+		return 1;
+	}
+
+	if (opts.convert_from) {
+		if (convert_trace_to_chrome_json(opts.convert_from, opts.convert_to)) return 0;
+		printf("Can't convert %s\n", opts.convert_from);
+		return 1;
+	}
+	if (opts.gate_before) return run_gate(opts);
+	if (opts.micro) return run_micro(opts);
+	if (opts.check) return run_check(opts);
+	if (opts.sizes) return print_sizes();
+	if (opts.cook) return run_cook(opts);
+
+	if (opts.trace) PROFILER_SESSION_BEGIN("headless");
+	defer { if (opts.trace) PROFILER_SESSION_END(opts.trace); };
+
+	if (opts.bench) return run_bench(opts);
+
+	Board realtime;
+	setup_board(realtime, opts);
+
+	Ressources realtime_gained = {};
+	auto start = xstd::seconds();
+	for (double t = 0; t < opts.seconds; t += opts.step) {
+		realtime.update(sound_orders, std::min(opts.step, opts.seconds - t));
+		realtime_gained = add(realtime_gained, realtime.ressources_gained);
+		next_sample_frame();
+		xstd::frame_arena().reset();
+	}
+	auto realtime_seconds = xstd::seconds() - start;
+
+	Board fast;
+	setup_board(fast, opts);
+
+	start = xstd::seconds();
+	fast.simulate(opts.seconds, opts.step);
+	auto fast_seconds = xstd::seconds() - start;
+
+	printf(
+		"wave %zu, %.1lfs of game in steps of %.4lfs\n", opts.wave, opts.seconds, opts.step
+	);
+	printf(
+		"update   % 10.2lf ms, gold % 6zu, units left % 6zu\n",
+		realtime_seconds * 1000,
+		realtime_gained.gold,
+		realtime.units.size() + realtime.crowd_size()
+	);
+	printf(
+		"simulate % 10.2lf ms, gold % 6zu, units left % 6zu\n",
+		fast_seconds * 1000,
+		fast.ressources_gained.gold,
+		fast.units.size() + fast.crowd_size()
+	);
+	printf("speedup  % 10.2lfx\n", realtime_seconds / xstd::max(fast_seconds, 1e-9));
+
+	return 0;
+}
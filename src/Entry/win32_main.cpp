@@ -355,6 +355,7 @@ void game_loop(DWORD main_thread_id) noexcept {
 				auto response = game_proc.update(
 					game, sound_orders, update_every_ns / 1'000'000'000.0
 				);
+				xstd::frame_arena().reset();
 
 				if (response.confine_cursor) {
 					RECT r;
@@ -427,6 +428,7 @@ void windows_loop() noexcept {
 
 	if (render_param.render) render::render_orders(orders, render_param);
 	orders.clear();
+	xstd::frame_arena().reset();
 
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -90,7 +90,7 @@ void Game::input(Input_Info in) noexcept {
 		if (in.scroll) {
 			float mult = 1/5.f;
 			if (in.key_infos[Keyboard::LSHIFT].pressed) mult = 1 / 20.f;
-			camera3d.pos.z *= std::powf(2, in.scroll * mult);
+			camera3d.pos.z *= std::pow(2.f, in.scroll * mult);
 			if (camera3d.pos.z < 1) camera3d.pos.z = 1;
 			if (camera3d.pos.z > 50) camera3d.pos.z = 50;
 		}
@@ -105,7 +105,7 @@ void Game::input(Input_Info in) noexcept {
 
 				if (
 					player.ressources.gold >= controller.placing->gold_cost &&
-					board.can_place_at(controller.placing->tile_rec)
+					board.can_place_at(controller.placing->tile_rec())
 				) {
 					board.insert_tower(controller.placing);
 					player.ressources.gold -= controller.placing->gold_cost;
@@ -163,12 +163,13 @@ void Game::input(Input_Info in) noexcept {
 	if (user_interface.action.state_button[Ui_State::Send_First].just_pressed) {
 		size_t next = (controller.board_id + 1) % boards.size();
 		auto to_spawn = Methane{};
+		auto& info = unit_info(Unit::Methane_Kind);
 
-		if (player.ressources.gold >= to_spawn.cost) {
-			player.ressources.gold -= to_spawn.cost;
-			players[controller.player_id].income += to_spawn.income;
+		if (player.ressources.gold >= info.cost) {
+			player.ressources.gold -= info.cost;
+			players[controller.player_id].income += info.income;
 
-			for (size_t i = 0; i < to_spawn.batch; ++i) boards[next].spawn_unit(to_spawn);
+			for (size_t i = 0; i < info.batch; ++i) boards[next].spawn_unit(to_spawn);
 		}
 	}
 
@@ -260,7 +261,7 @@ void Game::input(Input_Info in) noexcept {
 
 	if (!controller.tower_selected.empty()) {
 		// >TOWER_TARGET_MODE:
-		xstd::unordered_map<Ui_State, Tower_Target::Target_Mode> button_to_target_mode = {
+		static constexpr std::pair<Ui_State, Tower_Target::Target_Mode> button_to_target_mode[] = {
 			{Ui_State::Target_First, Tower_Target::First},
 			{Ui_State::Target_Farthest, Tower_Target::Farthest},
 			{Ui_State::Target_Closest, Tower_Target::Closest},
@@ -333,11 +334,22 @@ Game_Request Game::update(audio::Orders& audio_orders, double dt) noexcept {
 	user_interface.update(dt);
 
 	board.input(in, camera3d.project(in.mouse_pos));
+
+	Vector2f view_min = camera3d.project({0, 0});
+	Vector2f view_max = view_min;
+	for (auto corner : { Vector2f{1, 0}, Vector2f{0, 1}, Vector2f{1, 1} }) {
+		auto p = camera3d.project(corner);
+		view_min = { std::min(view_min.x, p.x), std::min(view_min.y, p.y) };
+		view_max = { std::max(view_max.x, p.x), std::max(view_max.y, p.y) };
+	}
+	for (auto& x : boards) x.view = Rectanglef{ view_min, view_max - view_min };
+
 	for (size_t i = 0; i < boards.size(); ++i) {
 		boards[i].update(audio_orders, dt);
 		players[i].ressources = add(players[i].ressources, boards[i].ressources_gained);
 		boards[i].ressources_gained = {};
 	}
+	set_entity_gauges(boards);
 
 	camera3d.pos += camera_speed * Vector3f(zqsd_vector, 0) * dt * camera3d.pos.z;
 
@@ -351,10 +363,13 @@ void Game::next_wave() noexcept {
 
 Game_Request game_update(Game& game, audio::Orders& audio_orders, double dt) noexcept {
 	auto res = game.update(audio_orders, dt);
+	next_sample_frame();
 
-	frame_sample_log_frame_idx++;
-	frame_sample_log_frame_idx %= Sample_Log::MAX_FRAME_RECORD;
-	frame_sample_log[frame_sample_log_frame_idx].sample_count = 0;
+	game.watchdog.end_frame([&] {
+		dyn_struct boards = dyn_struct::array_t{};
+		for (auto& x : game.boards) boards.push_back(x.snapshot());
+		return boards;
+	});
 
 	return res;
 }
@@ -386,12 +401,20 @@ void game_render(Game& game, render::Orders& order) noexcept {
 			1'000'000 * game.running_ms
 		);
 		size_t units = 0;
+		size_t crowd = 0;
 		size_t projectiles = 0;
 
 		for (auto& x : game.boards) units += x.units.size();
+		for (auto& x : game.boards) crowd += x.crowd_size();
 		for (auto& x : game.boards) projectiles += x.projectiles.size();
 		ImGui::Text("Units: %zu", units);
+		ImGui::Text("Crowd: %zu", crowd);
 		ImGui::Text("Projectiles: %zu", projectiles);
+		ImGui::Checkbox("Crowd simulation", &game.boards[game.controller.board_id].crowd_simulation);
+		ImGui::Checkbox("Hitch watchdog", &game.watchdog.enabled);
+		float budget = (float)game.watchdog.budget_ms;
+		if (ImGui::SliderFloat("Frame budget ms", &budget, 1, 100)) game.watchdog.budget_ms = budget;
+		ImGui::Text("Hitches captured: %zu", game.watchdog.captures);
 		ImGui::End();
 #endif
 	}
@@ -408,11 +431,12 @@ void game_render(Game& game, render::Orders& order) noexcept {
 
 			render::Rectangle rec;
 			rec.color = {1, 0, 0, 0.3f};
-			if (board.can_place_at(game.controller.placing->tile_rec)) rec.color = {0, 1, 0, .3f};
-			rec.rec = board.tile_box(
+			if (board.can_place_at(game.controller.placing->tile_rec())) rec.color = {0, 1, 0, .3f};
+			auto box = board.tile_box(
 				game.controller.placing->tile_pos, game.controller.placing->tile_size
 			);
-			rec.pos  += board.pos;
+			rec.pos  = box.pos + board.pos;
+			rec.size = box.size;
 			order.push(rec, 0.02f);
 		}
 		if (game.controller.board_id == i) {
@@ -451,8 +475,8 @@ void game_render(Game& game, render::Orders& order) noexcept {
 
 	if (game.gui.render_profiler) {
 		render::Camera cam;
-		cam.rec = {{0, 0}, {1920, 1080}};
-		cam.rec.pos += cam.rec.size / 2;
+		cam.frame_size = {1920, 1080};
+		cam.pos = cam.frame_size / 2;
 		order.push(render::Push_Ui{});
 		order.push(cam);
 
@@ -461,35 +485,31 @@ void game_render(Game& game, render::Orders& order) noexcept {
 			order.push(render::Pop_Ui{});
 		};
 
+		// The frame being recorded is left out, other threads may still be writing in it.
+		size_t now = current_sample_frame();
+		size_t first = 0;
+		if (now > Sample_Log::MAX_FRAME_RECORD) first = now - Sample_Log::MAX_FRAME_RECORD + 1;
+
 		thread_local std::set<const char*> function_names;
 		function_names.clear();
-		for (size_t i = 0; i < Sample_Log::MAX_FRAME_RECORD; ++i)
-			for (size_t j = 0; j < frame_sample_log[i].sample_count; ++j) {
-				function_names.insert(frame_sample_log[i].samples[j].function_name);
-			}
-
 		size_t max_time = 0;
-		for (size_t i = 0; i < Sample_Log::MAX_FRAME_RECORD; ++i) {
-			for (size_t j = 0; j < frame_sample_log[i].sample_count; ++j) {
-				auto& it = frame_sample_log[i].samples[j];
-				max_time = xstd::max(max_time, (size_t)(it.time_end - it.time_start));
-			}
-		}
+		for (size_t i = first; i < now; ++i) for_each_sample(i, [&] (const Sample& it) {
+			function_names.insert(it.function_name);
+			max_time = xstd::max(max_time, (size_t)ticks_to_ns(it.time_end - it.time_start));
+		});
 		max_time = xstd::max(max_time, (size_t)2'200'000 /*ns*/);
 
 		Vector2f cursor = {10, 10};
-		for (size_t i = 0; i < Sample_Log::MAX_FRAME_RECORD; ++i) {
+		for (size_t i = first; i < now; ++i) {
 			float cursor_y = cursor.y;
-			auto& it = frame_sample_log[i];
 
 			for (auto& f : function_names) {
 				size_t sum = 0;
-				for (size_t j = 0; j < it.sample_count; ++j) {
-					auto& sample = it.samples[j];
-					if (sample.function_name != f) continue;
+				for_each_sample(i, [&] (const Sample& sample) {
+					if (sample.function_name != f) return;
 
-					sum += sample.time_end - sample.time_start;
-				}
+					sum += (size_t)ticks_to_ns(sample.time_end - sample.time_start);
+				});
 
 				render::Rectangle r;
 				r.pos = cursor;
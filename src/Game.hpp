@@ -17,6 +17,8 @@
 
 #include "Player.hpp"
 
+#include "Profiler/Frame_Watchdog.hpp"
+
 struct Controller {
 	size_t board_id  = 0;
 	size_t player_id = 0;
@@ -72,6 +74,8 @@ struct Game {
 
 	double running_ms = 0;
 
+	Frame_Watchdog watchdog;
+
 	Game() noexcept {
 		camera3d.pos = {0, -12, 30};
 		camera3d.look_at({});
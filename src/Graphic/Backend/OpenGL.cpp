@@ -745,7 +745,7 @@ void opengl_debug(
 	printf("\n");
 
 	if (std::find(BEG_END(To_Break_On), id) != std::end(To_Break_On)) {
-		#ifndef WEB
+		#ifdef _WIN32
 		DebugBreak();
 		#endif
 	}
@@ -0,0 +1,367 @@
+#include "Mesh_Cache.hpp"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "OS/file.hpp"
+
+static_assert(sizeof(mesh::Header) == 56, "It's written as is.");
+
+static xstd::vector<std::uint32_t> get_indices(const Object& obj) noexcept {
+	xstd::vector<std::uint32_t> indices;
+	indices.resize(obj.index_count());
+	if (obj.wide_indices()) {
+		memcpy(indices.data(), obj.faces_32.data(), obj.index_bytes());
+	} else {
+		for (size_t i = 0; i < obj.faces.size(); ++i) indices[i] = obj.faces[i];
+	}
+	return indices;
+}
+
+// 16 bits if the vertices fit.
+static void set_indices(Object& obj, const xstd::vector<std::uint32_t>& indices) noexcept {
+	obj.faces.clear();
+	obj.faces_32.clear();
+	if (obj.vertices.size() > 65536) {
+		obj.faces_32 = indices;
+		return;
+	}
+
+	obj.faces.resize(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i) obj.faces[i] = (std::uint16_t)indices[i];
+}
+
+void mesh::deduplicate_vertices(Object& obj) noexcept {
+	auto& vertices = obj.vertices;
+
+	// Sorted by their bytes the same ones are next to each other, stable so the first of a run
+	// is the one that comes first.
+	xstd::vector<std::uint32_t> order;
+	order.resize(vertices.size());
+	for (size_t i = 0; i < order.size(); ++i) order[i] = (std::uint32_t)i;
+	std::stable_sort(order.begin(), order.end(), [&] (auto a, auto b) {
+		return memcmp(&vertices[a], &vertices[b], sizeof(Object::Vertex)) < 0;
+	});
+
+	xstd::vector<std::uint32_t> remap;
+	remap.resize(vertices.size());
+	for (size_t i = 0; i < order.size(); ++i) {
+		auto same = i > 0 && memcmp(
+			&vertices[order[i]], &vertices[order[i - 1]], sizeof(Object::Vertex)
+		) == 0;
+		remap[order[i]] = same ? remap[order[i - 1]] : order[i];
+	}
+
+	// Faces that lost a corner that way draw nothing, they go.
+	auto indices = get_indices(obj);
+	xstd::vector<std::uint32_t> kept;
+	kept.reserve(indices.size());
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		auto a = remap[indices[i + 0]];
+		auto b = remap[indices[i + 1]];
+		auto c = remap[indices[i + 2]];
+		if (a == b || b == c || c == a) continue;
+		kept.push_back(a);
+		kept.push_back(b);
+		kept.push_back(c);
+	}
+	set_indices(obj, kept);
+}
+
+// The constants of the paper.
+static constexpr size_t Cache_Size = 32;
+
+static float vertex_score(int cache_position, std::uint32_t faces_left) noexcept {
+	if (faces_left == 0) return -1;
+
+	float score = 0;
+	if (cache_position >= 0) {
+		// The last face's vertices get a fixed score, no matter the order they came in.
+		if (cache_position < 3) score = 0.75f;
+		else score = powf(1 - (cache_position - 3) / (float)(Cache_Size - 3), 1.5f);
+	}
+	// Vertices with few faces left are finished first, they'd be reloaded later otherwise.
+	score += 2.f * powf((float)faces_left, -0.5f);
+	return score;
+}
+
+void mesh::optimize_vertex_cache(Object& obj) noexcept {
+	auto indices = get_indices(obj);
+	size_t n_vertex = obj.vertices.size();
+	size_t n_face = indices.size() / 3;
+	if (n_face == 0) return;
+
+	// The faces of each vertex, the ones still to emit first: faces_left of them.
+	xstd::vector<std::uint32_t> faces_left;
+	xstd::vector<std::uint32_t> first_face;
+	xstd::vector<std::uint32_t> vertex_faces;
+	faces_left.resize(n_vertex, 0);
+	first_face.resize(n_vertex + 1, 0);
+	vertex_faces.resize(indices.size());
+
+	for (auto x : indices) faces_left[x]++;
+	for (size_t i = 0; i < n_vertex; ++i) first_face[i + 1] = first_face[i] + faces_left[i];
+	{
+		xstd::vector<std::uint32_t> filled;
+		filled.resize(n_vertex, 0);
+		for (size_t i = 0; i < indices.size(); ++i) {
+			auto v = indices[i];
+			vertex_faces[first_face[v] + filled[v]++] = (std::uint32_t)(i / 3);
+		}
+	}
+
+	xstd::vector<int> cache_position;
+	xstd::vector<float> score;
+	cache_position.resize(n_vertex, -1);
+	score.resize(n_vertex);
+	for (size_t i = 0; i < n_vertex; ++i) score[i] = vertex_score(-1, faces_left[i]);
+
+	xstd::vector<float> face_score;
+	xstd::vector<bool> emitted;
+	face_score.resize(n_face);
+	emitted.resize(n_face, false);
+	auto score_face = [&] (size_t f) {
+		auto face = indices.data() + 3 * f;
+		return score[face[0]] + score[face[1]] + score[face[2]];
+	};
+	for (size_t f = 0; f < n_face; ++f) face_score[f] = score_face(f);
+
+	// The cache, and the 3 that get pushed out of it by the last face.
+	std::uint32_t cache[Cache_Size + 3];
+	size_t cache_count = 0;
+
+	xstd::vector<std::uint32_t> result;
+	result.reserve(indices.size());
+
+	size_t best = SIZE_MAX;
+	for (size_t emitted_count = 0; emitted_count < n_face; ++emitted_count) {
+		// Nothing in the cache has faces left, start over from the best of the rest. Rare, it
+		// happens once per disconnected part.
+		if (best == SIZE_MAX) {
+			float best_score = -FLT_MAX;
+			for (size_t f = 0; f < n_face; ++f) {
+				if (emitted[f] || face_score[f] <= best_score) continue;
+				best_score = face_score[f];
+				best = f;
+			}
+		}
+
+		auto face = indices.data() + 3 * best;
+		for (size_t i = 0; i < 3; ++i) result.push_back(face[i]);
+		emitted[best] = true;
+
+		// Moves the emitted face past the ones still to emit.
+		for (size_t i = 0; i < 3; ++i) {
+			auto v = face[i];
+			auto begin = vertex_faces.data() + first_face[v];
+			auto it = std::find(begin, begin + faces_left[v], (std::uint32_t)best);
+			std::swap(*it, begin[faces_left[v] - 1]);
+			faces_left[v]--;
+		}
+
+		// The face's vertices go in front, the rest keep their order behind them.
+		std::uint32_t next[Cache_Size + 3];
+		size_t next_count = 0;
+		for (size_t i = 0; i < 3; ++i) next[next_count++] = face[i];
+		for (size_t i = 0; i < cache_count; ++i) {
+			auto v = cache[i];
+			if (v != face[0] && v != face[1] && v != face[2]) next[next_count++] = v;
+		}
+
+		for (size_t i = 0; i < next_count; ++i) {
+			auto v = next[i];
+			cache_position[v] = i < Cache_Size ? (int)i : -1;
+			score[v] = vertex_score(cache_position[v], faces_left[v]);
+		}
+
+		// Only faces of vertices whose score changed can have a new score.
+		best = SIZE_MAX;
+		float best_score = -FLT_MAX;
+		for (size_t i = 0; i < next_count; ++i) {
+			auto v = next[i];
+			auto begin = vertex_faces.data() + first_face[v];
+			for (auto it = begin; it != begin + faces_left[v]; ++it) {
+				face_score[*it] = score_face(*it);
+				if (face_score[*it] <= best_score) continue;
+				best_score = face_score[*it];
+				best = *it;
+			}
+		}
+
+		cache_count = std::min(next_count, Cache_Size);
+		memcpy(cache, next, cache_count * sizeof(*cache));
+	}
+
+	set_indices(obj, result);
+}
+
+void mesh::optimize_vertex_fetch(Object& obj) noexcept {
+	auto indices = get_indices(obj);
+
+	constexpr std::uint32_t Unused = UINT32_MAX;
+	xstd::vector<std::uint32_t> remap;
+	remap.resize(obj.vertices.size(), Unused);
+
+	xstd::vector<Object::Vertex> vertices;
+	for (auto& x : indices) {
+		if (remap[x] == Unused) {
+			remap[x] = (std::uint32_t)vertices.size();
+			vertices.push_back(obj.vertices[x]);
+		}
+		x = remap[x];
+	}
+
+	obj.vertices = std::move(vertices);
+	set_indices(obj, indices);
+}
+
+double mesh::acmr(const Object& obj, size_t cache_size) noexcept {
+	auto indices = get_indices(obj);
+	if (indices.size() < 3) return 0;
+
+	// What time each vertex went in the FIFO, it's still there if less than cache_size
+	// misses happened since.
+	xstd::vector<size_t> loaded_at;
+	loaded_at.resize(obj.vertices.size(), SIZE_MAX);
+
+	size_t misses = 0;
+	for (auto x : indices) {
+		if (loaded_at[x] != SIZE_MAX && misses - loaded_at[x] < cache_size) continue;
+		loaded_at[x] = misses++;
+	}
+	return misses / (indices.size() / 3.0);
+}
+
+void mesh::cook(Object& obj) noexcept {
+	deduplicate_vertices(obj);
+	optimize_vertex_cache(obj);
+	optimize_vertex_fetch(obj);
+}
+
+std::filesystem::path mesh::cache_path(const std::filesystem::path& source) noexcept {
+	auto path = source;
+	path.replace_extension(".mesh");
+	return path;
+}
+
+// Whether the cache was made from this very file. The write time isn't portable from one
+// machine to the other, caches are local and not versioned.
+static bool stamp(
+	const std::filesystem::path& source, std::uint64_t& size, std::int64_t& time
+) noexcept {
+	std::error_code ec;
+	size = (std::uint64_t)std::filesystem::file_size(source, ec);
+	if (ec) return false;
+	time = (std::int64_t)std::filesystem::last_write_time(source, ec).time_since_epoch().count();
+	return !ec;
+}
+
+bool mesh::write_cache(
+	const Object& obj, const std::filesystem::path& source, const std::filesystem::path& to
+) noexcept {
+	Header header;
+	if (!stamp(source, header.source_size, header.source_time)) return false;
+	header.n_vertex = (std::uint32_t)obj.vertices.size();
+	header.n_index = (std::uint32_t)obj.index_count();
+	header.index_size = obj.wide_indices() ? 4 : 2;
+	header.n_lod = 1;
+	header.size[0] = obj.size.x;
+	header.size[1] = obj.size.y;
+	header.size[2] = obj.size.z;
+
+	Lod lod;
+	lod.first_index = 0;
+	lod.index_count = header.n_index;
+
+	auto vertex_bytes = obj.vertices.size() * sizeof(Object::Vertex);
+
+	xstd::vector<std::uint8_t> bytes;
+	bytes.resize(sizeof(header) + sizeof(lod) + vertex_bytes + obj.index_bytes());
+	auto it = bytes.data();
+	memcpy(it, &header, sizeof(header));
+	it += sizeof(header);
+	memcpy(it, &lod, sizeof(lod));
+	it += sizeof(lod);
+	memcpy(it, obj.vertices.data(), vertex_bytes);
+	it += vertex_bytes;
+	memcpy(it, obj.index_data(), obj.index_bytes());
+
+	return file::overwrite_file_byte(to, bytes);
+}
+
+std::optional<Object> mesh::load_cache(
+	const std::filesystem::path& source, const std::filesystem::path& from
+) noexcept {
+	std::uint64_t source_size = 0;
+	std::int64_t source_time = 0;
+	if (!stamp(source, source_size, source_time)) return std::nullopt;
+
+	auto file = file::map_file(from);
+	if (!file || file->size < sizeof(Header)) return std::nullopt;
+
+	Header header;
+	memcpy(&header, file->data, sizeof(header));
+	if (memcmp(header.magic, Header().magic, sizeof(header.magic)) != 0) return std::nullopt;
+	if (header.version != Version) return std::nullopt;
+	if (header.source_size != source_size || header.source_time != source_time) {
+		return std::nullopt;
+	}
+	if (header.index_size != 2 && header.index_size != 4) return std::nullopt;
+	if (header.n_lod == 0) return std::nullopt;
+
+	// A cache cut short, by a write that didn't finish say.
+	size_t lod_bytes = header.n_lod * sizeof(Lod);
+	size_t vertex_bytes = header.n_vertex * sizeof(Object::Vertex);
+	size_t index_bytes = header.n_index * header.index_size;
+	if (sizeof(Header) + lod_bytes + vertex_bytes + index_bytes != file->size) {
+		return std::nullopt;
+	}
+
+	auto it = file->data + sizeof(Header);
+	Lod lod;
+	memcpy(&lod, it, sizeof(lod));
+	it += lod_bytes;
+	if ((size_t)lod.first_index + lod.index_count > header.n_index) return std::nullopt;
+
+	Object obj;
+	obj.size = { header.size[0], header.size[1], header.size[2] };
+	obj.vertices.resize(header.n_vertex);
+	memcpy(obj.vertices.data(), it, vertex_bytes);
+	it += vertex_bytes;
+
+	it += (size_t)lod.first_index * header.index_size;
+	std::uint32_t top = 0;
+	if (header.index_size == 4) {
+		obj.faces_32.resize(lod.index_count);
+		memcpy(obj.faces_32.data(), it, lod.index_count * 4);
+		for (auto x : obj.faces_32) top = std::max(top, x);
+	} else {
+		obj.faces.resize(lod.index_count);
+		memcpy(obj.faces.data(), it, lod.index_count * 2);
+		for (auto x : obj.faces) top = std::max(top, (std::uint32_t)x);
+	}
+	if (lod.index_count > 0 && top >= header.n_vertex) return std::nullopt;
+
+	return obj;
+}
+
+std::optional<Object> mesh::load_object(const std::filesystem::path& source) noexcept {
+	auto cache = cache_path(source);
+	if (auto obj = load_cache(source, cache)) return obj;
+
+	auto obj = Object::load_from_file(source);
+	if (!obj) return std::nullopt;
+	cook(*obj);
+
+	// Nowhere to write it to in the browser.
+#ifndef WEB
+	if (!write_cache(*obj, source, cache)) {
+		auto str = cache.string();
+		printf("Can't write the mesh cache %s.\n", str.c_str());
+	}
+#endif
+	return obj;
+}
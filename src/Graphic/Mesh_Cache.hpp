@@ -0,0 +1,69 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <stdint.h>
+
+#include "Graphic/Object.hpp"
+
+// Models cooked once and kept next to their PLY as a .mesh: vertices already moved to their
+// min corner, duplicates merged, faces in an order the post transform cache likes and
+// vertices in the order the faces use them. Loading one is a single mapped read and two
+// memcpy. A cache is only used if it was cooked by this version from a source file of the
+// same size and write time, else the PLY is loaded, cooked and the cache written again.
+namespace mesh {
+	// Bump when the layout or what cooking does changes, every cache gets cooked again.
+	constexpr std::uint32_t Version = 1;
+
+	// A range of the index buffer, all levels share the vertices. Level 0 is the full mesh,
+	// the others would be coarser versions of it, cooking only makes level 0 for now.
+	struct Lod {
+		std::uint32_t first_index = 0;
+		std::uint32_t index_count = 0;
+	};
+
+	// Then n_lod Lod, n_vertex Object::Vertex, and n_index indices of index_size bytes.
+	struct Header {
+		char magic[4] = { 'L', 'T', 'W', 'M' };
+		std::uint32_t version = Version;
+		std::uint64_t source_size = 0;
+		std::int64_t source_time = 0;
+		std::uint32_t n_vertex = 0;
+		std::uint32_t n_index = 0;
+		std::uint32_t index_size = 0;
+		std::uint32_t n_lod = 0;
+		// Bounds, the min corner is 0.
+		float size[3] = {};
+		std::uint32_t pad = 0;
+	};
+
+	// Faces point to the first of the vertices that are the same bit for bit, the others are
+	// left unused. Faces left with twice the same vertex are dropped.
+	extern void deduplicate_vertices(Object& obj) noexcept;
+	// Tom Forsyth's linear-speed vertex cache optimisation: the next face is the one whose
+	// vertices are the most recently used and have the fewest faces left.
+	extern void optimize_vertex_cache(Object& obj) noexcept;
+	// Vertices renumbered in the order the faces first use them, unused ones dropped.
+	extern void optimize_vertex_fetch(Object& obj) noexcept;
+	// Vertices transformed per face with a FIFO post transform cache of cache_size, 3 is the
+	// worst, 0.5 about the best for a regular grid.
+	extern double acmr(const Object& obj, size_t cache_size = 16) noexcept;
+
+	// All three above, in order.
+	extern void cook(Object& obj) noexcept;
+
+	extern std::filesystem::path cache_path(const std::filesystem::path& source) noexcept;
+
+	[[nodiscard]] extern bool write_cache(
+		const Object& obj, const std::filesystem::path& source, const std::filesystem::path& to
+	) noexcept;
+	// nullopt if there is none or it's stale.
+	[[nodiscard]] extern std::optional<Object> load_cache(
+		const std::filesystem::path& source, const std::filesystem::path& from
+	) noexcept;
+
+	// The cache of source if it's good, else source cooked, and the cache written again.
+	[[nodiscard]] extern std::optional<Object> load_object(
+		const std::filesystem::path& source
+	) noexcept;
+};
@@ -1,73 +1,283 @@
 #include "Object.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <charconv>
 #include <float.h>
+#include <stddef.h>
+#include <string.h>
+#include <string_view>
 
 #include "OS/file.hpp"
 
-std::optional<Object> Object::load_from_file(
-	const std::filesystem::path& path
-) noexcept {
-	auto opt_str = file::read_whole_text(path);
-	if (!opt_str) return std::nullopt;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OBJECT_SSE2
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#define OBJECT_WASM
+#include <wasm_simd128.h>
+#endif
 
-	auto& file = *opt_str;
-	Object obj;
+// The one layout Blender writes and load_from_file reads: 8 floats per vertex, and faces as a
+// list of 3 uint with an uchar count, 13 bytes each.
+static_assert(sizeof(Object::Vertex) == 8 * sizeof(float));
+static_assert(offsetof(Object::Vertex, pos) == 0);
+static constexpr size_t Face_Size = 1 + 3 * sizeof(std::uint32_t);
 
+struct Ply_Header {
+	size_t n_vertex = 0;
+	size_t n_face = 0;
+	// Where the vertices start.
+	size_t size = 0;
+};
+
+static std::optional<Ply_Header> parse_ply_header(std::string_view text) noexcept {
+	Ply_Header header;
+	size_t vertex_floats = 0;
+	bool face_list = false;
+
+	std::string_view element;
+	bool first = true;
 	size_t cursor = 0;
+	while (true) {
+		auto eol = text.find('\n', cursor);
+		if (eol == std::string_view::npos) return std::nullopt;
 
-	std::string line;
-	std::stringstream file_stream(file);
+		auto line = text.substr(cursor, eol - cursor);
+		cursor = eol + 1;
+		if (line.ends_with('\r')) line.remove_suffix(1);
 
-	size_t n_vertex = 0;
-	size_t n_face   = 0;
-	while (std::getline(file_stream, line)) {
-		cursor += line.size() + 1;
-		if (line.starts_with("comment")) continue;
-		if (line.starts_with("element vertex")) {
-			n_vertex = std::strtoull(line.data() + sizeof("element vertex"), nullptr, 10);
-			continue;
+		if (first && line != "ply") return std::nullopt;
+		first = false;
+
+		if (line == "end_header") break;
+		if (line.starts_with("format") && line != "format binary_little_endian 1.0") {
+			return std::nullopt;
 		}
-		if (line.starts_with("element face")) {
-			n_face = std::strtoull(line.data() + sizeof("element face"), nullptr, 10);
+
+		if (line.starts_with("element ")) {
+			line.remove_prefix(sizeof("element ") - 1);
+			auto space = line.find(' ');
+			if (space == std::string_view::npos) return std::nullopt;
+			element = line.substr(0, space);
+
+			size_t n = 0;
+			auto count = line.substr(space + 1);
+			std::from_chars(count.data(), count.data() + count.size(), n);
+
+			// The vertices have to come first, that's where the faces are read from.
+			if (element == "vertex" && header.n_face == 0) header.n_vertex = n;
+			else if (element == "face") header.n_face = n;
+			else if (n > 0) return std::nullopt;
 			continue;
 		}
-		if (line == "end_header") break;
+
+		if (line.starts_with("property ")) {
+			if (element == "vertex") {
+				if (!line.starts_with("property float ")) return std::nullopt;
+				vertex_floats++;
+			}
+			if (element == "face") {
+				face_list =
+					line == "property list uchar uint vertex_indices" ||
+					line == "property list uchar int vertex_indices";
+				if (!face_list) return std::nullopt;
+			}
+		}
 	}
 
-	for (size_t i = 0; i < n_vertex; ++i) {
-		thread_local Vertex temp;
-		memcpy(&temp, file.data() + cursor, sizeof(Vertex));
+	if (vertex_floats != sizeof(Object::Vertex) / sizeof(float)) return std::nullopt;
+	if (header.n_face > 0 && !face_list) return std::nullopt;
 
-		obj.vertices.push_back(temp);
-		cursor += sizeof(Vertex);
-	}
+	header.size = cursor;
+	return header;
+}
 
-	for (size_t i = 0; i < n_face; ++i) {
-		assert(file[cursor] == 3);
-		cursor++;
+// Moves every position so the min corner is at 0 and size is the max one. Lane 3 of each load
+// is the normal's x, it's left out of the bounds and nothing is added to it.
+static void normalize_positions(Object& obj) noexcept {
+	auto& vertices = obj.vertices;
+	obj.size = {};
+	if (vertices.size() == 0) return;
+
+	Vector3f m;
+	Vector3f M;
+
+#if defined(OBJECT_SSE2)
+	auto lo = _mm_set1_ps(FLT_MAX);
+	auto hi = _mm_set1_ps(-FLT_MAX);
+	for (auto& x : vertices) {
+		auto p = _mm_loadu_ps(&x.pos.x);
+		lo = _mm_min_ps(lo, p);
+		hi = _mm_max_ps(hi, p);
+	}
+	alignas(16) float lo_lanes[4];
+	alignas(16) float hi_lanes[4];
+	_mm_store_ps(lo_lanes, lo);
+	_mm_store_ps(hi_lanes, hi);
+	m = { lo_lanes[0], lo_lanes[1], lo_lanes[2] };
+	M = { hi_lanes[0], hi_lanes[1], hi_lanes[2] };
 
-		obj.faces.push_back((std::uint16_t)*reinterpret_cast<std::uint32_t*>(file.data() + cursor));
-		cursor += 4;
-		obj.faces.push_back((std::uint16_t)*reinterpret_cast<std::uint32_t*>(file.data() + cursor));
-		cursor += 4;
-		obj.faces.push_back((std::uint16_t)*reinterpret_cast<std::uint32_t*>(file.data() + cursor));
-		cursor += 4;
+	auto shift = _mm_set_ps(0, m.z, m.y, m.x);
+	for (auto& x : vertices) {
+		_mm_storeu_ps(&x.pos.x, _mm_sub_ps(_mm_loadu_ps(&x.pos.x), shift));
 	}
+#elif defined(OBJECT_WASM)
+	auto lo = wasm_f32x4_splat(FLT_MAX);
+	auto hi = wasm_f32x4_splat(-FLT_MAX);
+	for (auto& x : vertices) {
+		auto p = wasm_v128_load(&x.pos.x);
+		lo = wasm_f32x4_pmin(lo, p);
+		hi = wasm_f32x4_pmax(hi, p);
+	}
+	alignas(16) float lo_lanes[4];
+	alignas(16) float hi_lanes[4];
+	wasm_v128_store(lo_lanes, lo);
+	wasm_v128_store(hi_lanes, hi);
+	m = { lo_lanes[0], lo_lanes[1], lo_lanes[2] };
+	M = { hi_lanes[0], hi_lanes[1], hi_lanes[2] };
 
-	Vector3f m{ FLT_MAX, FLT_MAX, FLT_MAX };
-	for (auto& x : obj.vertices) {
+	auto shift = wasm_f32x4_make(m.x, m.y, m.z, 0);
+	for (auto& x : vertices) {
+		wasm_v128_store(&x.pos.x, wasm_f32x4_sub(wasm_v128_load(&x.pos.x), shift));
+	}
+#else
+	m = { FLT_MAX, FLT_MAX, FLT_MAX };
+	M = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (auto& x : vertices) {
 		m.x = std::min(m.x, x.pos.x);
 		m.y = std::min(m.y, x.pos.y);
 		m.z = std::min(m.z, x.pos.z);
+		M.x = std::max(M.x, x.pos.x);
+		M.y = std::max(M.y, x.pos.y);
+		M.z = std::max(M.z, x.pos.z);
+	}
+	for (auto& x : vertices) x.pos -= m;
+#endif
+
+	// Rounding goes the same way for every vertex, this is the max of the moved positions.
+	obj.size = M - m;
+}
+
+// From the face records to 3 indices per face, 16 bits when every vertex fits in it. False
+// when a face isn't a triangle or points past the last vertex.
+// Each record is read with one unaligned load of 16 bytes: its count, its 3 indices, and the
+// start of the next one that's masked out. The last face has no next one, it's done alone.
+static bool read_indices(
+	const std::uint8_t* src, size_t n_face, size_t n_vertex, Object& obj
+) noexcept {
+	bool wide = n_vertex > 65536;
+	std::uint16_t* out = nullptr;
+	std::uint32_t* out_32 = nullptr;
+	// One more index at the end, the vector stores write 4 at a time.
+	if (wide) {
+		obj.faces_32.resize(3 * n_face + 1);
+		out_32 = obj.faces_32.data();
+	} else {
+		obj.faces.resize(3 * n_face + 1);
+		out = obj.faces.data();
 	}
-	for (auto& x : obj.vertices) x.pos -= m;
 
-	for (auto& x : obj.vertices) {
-		obj.size.x = std::max(obj.size.x, x.pos.x);
-		obj.size.y = std::max(obj.size.y, x.pos.y);
-		obj.size.z = std::max(obj.size.z, x.pos.z);
+	std::uint32_t bad = 0;
+	std::uint32_t top = 0;
+	size_t i = 0;
+
+#if defined(OBJECT_SSE2)
+	// No unsigned max in SSE2, compare with the sign bit flipped.
+	const auto sign = _mm_set1_epi32(INT32_MIN);
+	const auto lanes = _mm_set_epi32(0, -1, -1, -1);
+	const auto bias_32 = _mm_set1_epi32(0x8000);
+	const auto bias_16 = _mm_set1_epi16(INT16_MIN);
+	auto top_v = sign;
+
+	for (; i + 1 < n_face; ++i) {
+		auto x = _mm_loadu_si128((const __m128i*)(src + i * Face_Size));
+		bad |= (_mm_cvtsi128_si32(x) & 0xFF) ^ 3;
+
+		auto idx = _mm_and_si128(_mm_srli_si128(x, 1), lanes);
+		auto flipped = _mm_xor_si128(idx, sign);
+		auto gt = _mm_cmpgt_epi32(flipped, top_v);
+		top_v = _mm_or_si128(_mm_and_si128(gt, flipped), _mm_andnot_si128(gt, top_v));
+
+		if (wide) {
+			_mm_storeu_si128((__m128i*)(out_32 + 3 * i), idx);
+		} else {
+			// packs saturates to signed, move [0, 65536[ there and back.
+			auto words = _mm_packs_epi32(_mm_sub_epi32(idx, bias_32), _mm_setzero_si128());
+			_mm_storel_epi64((__m128i*)(out + 3 * i), _mm_add_epi16(words, bias_16));
+		}
 	}
 
+	alignas(16) std::uint32_t top_lanes[4];
+	_mm_store_si128((__m128i*)top_lanes, _mm_xor_si128(top_v, sign));
+	for (auto x : top_lanes) top = std::max(top, x);
+#elif defined(OBJECT_WASM)
+	const auto lanes = wasm_i32x4_make(-1, -1, -1, 0);
+	auto top_v = wasm_i32x4_splat(0);
+
+	for (; i + 1 < n_face; ++i) {
+		auto x = wasm_v128_load(src + i * Face_Size);
+		bad |= wasm_u8x16_extract_lane(x, 0) ^ 3;
+
+		auto shifted = wasm_i8x16_shuffle(
+			x, wasm_i32x4_splat(0), 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16
+		);
+		auto idx = wasm_v128_and(shifted, lanes);
+		top_v = wasm_u32x4_max(top_v, idx);
+
+		if (wide) {
+			wasm_v128_store(out_32 + 3 * i, idx);
+		} else {
+			// Saturates from signed, what doesn't fit is past n_vertex and caught by top.
+			auto words = wasm_u16x8_narrow_i32x4(idx, idx);
+			wasm_v128_store64_lane(out + 3 * i, words, 0);
+		}
+	}
+
+	alignas(16) std::uint32_t top_lanes[4];
+	wasm_v128_store(top_lanes, top_v);
+	for (auto x : top_lanes) top = std::max(top, x);
+#endif
+
+	for (; i < n_face; ++i) {
+		auto rec = src + i * Face_Size;
+		bad |= rec[0] ^ 3;
+
+		std::uint32_t idx[3];
+		memcpy(idx, rec + 1, sizeof(idx));
+		top = std::max(top, std::max(idx[0], std::max(idx[1], idx[2])));
+
+		for (size_t j = 0; j < 3; ++j) {
+			if (wide) out_32[3 * i + j] = idx[j];
+			else      out[3 * i + j] = (std::uint16_t)idx[j];
+		}
+	}
+
+	if (wide) obj.faces_32.resize(3 * n_face);
+	else      obj.faces.resize(3 * n_face);
+
+	return bad == 0 && (n_face == 0 || top < n_vertex);
+}
+
+std::optional<Object> Object::load_from_file(
+	const std::filesystem::path& path
+) noexcept {
+	auto file = file::map_file(path);
+	if (!file) return std::nullopt;
+
+	auto header = parse_ply_header(file->view());
+	if (!header) return std::nullopt;
+
+	auto vertex_bytes = header->n_vertex * sizeof(Vertex);
+	auto face_bytes = header->n_face * Face_Size;
+	if (header->size + vertex_bytes + face_bytes > file->size) return std::nullopt;
+
+	Object obj;
+	obj.vertices.resize(header->n_vertex);
+	memcpy(obj.vertices.data(), file->data + header->size, vertex_bytes);
+
+	auto faces = file->data + header->size + vertex_bytes;
+	if (!read_indices(faces, header->n_face, header->n_vertex, obj)) return std::nullopt;
+
+	normalize_positions(obj);
 	return obj;
 }
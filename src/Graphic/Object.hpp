@@ -11,17 +11,9 @@ struct Object {
 	Object(Object&) = delete;
 	Object& operator=(Object&) = delete;
 
-	Object(Object&& other) noexcept {
-		this->~Object();
-		memcpy(this, &other, sizeof(other));
-		memset(&other, 0, sizeof(other));
-	}
-	Object& operator=(Object&& other) noexcept {
-		this->~Object();
-		memcpy(this, &other, sizeof(other));
-		memset(&other, 0, sizeof(other));
-		return *this;
-	}
+	// Member by member, a memcpy of the strings breaks the ones that point in themselves.
+	Object(Object&& other) noexcept = default;
+	Object& operator=(Object&& other) noexcept = default;
 
 	static std::optional<Object> load_from_file(
 		const std::filesystem::path& path
@@ -41,5 +33,19 @@ struct Object {
 		Vector2f uv;
 	};
 	xstd::vector<Vertex> vertices;
-	xstd::vector<unsigned short> faces;
+	// Three indices per triangle, 16 bits unless there are too many vertices for it. Only one
+	// of the two is filled.
+	xstd::vector<std::uint16_t> faces;
+	xstd::vector<std::uint32_t> faces_32;
+
+	bool wide_indices() const noexcept { return !faces_32.empty(); }
+	size_t index_count() const noexcept {
+		return wide_indices() ? faces_32.size() : faces.size();
+	}
+	size_t index_bytes() const noexcept {
+		return wide_indices() ? faces_32.size() * 4 : faces.size() * 2;
+	}
+	const void* index_data() const noexcept {
+		return wide_indices() ? (const void*)faces_32.data() : (const void*)faces.data();
+	}
 };
\ No newline at end of file
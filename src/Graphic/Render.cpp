@@ -9,6 +9,8 @@
 
 #include "xstd.hpp"
 
+#include "Profiler/Counters.hpp"
+
 render::Order render::current_camera;
 
 void render::Camera3D::look_at(Vector3f target) noexcept {
@@ -75,6 +77,7 @@ void render::Orders::push(render::Order o) noexcept {
 }
 
 void render::Orders::push(render::Order o, float z) noexcept {
+	PROFILER_COUNTER_ADD("render orders pushed", 1);
 	o->z = z;
 	commands.push_back(std::move(o));
 }
@@ -800,7 +803,7 @@ void render::immediate(Sprite info) noexcept {
 
 struct Gpu_Vector {
 
-	void upload(size_t size, void* data) noexcept {
+	void upload(size_t size, const void* data) noexcept {
 		glBindBuffer(target, buffer);
 		glBufferData(target, size, data, GL_DYNAMIC_DRAW);
 	}
@@ -842,10 +845,10 @@ void render::immediate(Model info) noexcept {
 	indices.target = GL_ELEMENT_ARRAY_BUFFER;
 
 	vertices.fit(object.vertices.size() * sizeof(Object::Vertex));
-	indices.fit(object.faces.size() * sizeof(size_t));
+	indices.fit(object.index_bytes());
 
 	vertices.upload(object.vertices.size() * sizeof(Object::Vertex), object.vertices.data());
-	indices.upload(object.faces.size() * sizeof(unsigned short), object.faces.data());
+	indices.upload(object.index_bytes(), object.index_data());
 
 	auto& cam = current_camera.Camera3D_;
 
@@ -874,7 +877,8 @@ void render::immediate(Model info) noexcept {
 	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Object::Vertex), (void*)24);
 
 	glBindBuffer(indices.target, indices.buffer);
-	glDrawElements(GL_TRIANGLES, object.vertices.size() * 3, GL_UNSIGNED_SHORT, (void*)0);
+	auto index_type = object.wide_indices() ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+	glDrawElements(GL_TRIANGLES, object.index_count(), index_type, (void*)0);
 
 	for (size_t i = 0; i < 3; ++i) glDisableVertexAttribArray(i);
 }
@@ -1345,10 +1349,10 @@ void render::immediate(
 
 	device_instance_data.fit(models.size() * GPU_Instance_Size);
 	vertices.fit(object.vertices.size() * sizeof(Object::Vertex));
-	indices.fit(object.faces.size() * sizeof(size_t));
+	indices.fit(object.index_bytes());
 
 	vertices.upload(object.vertices.size() * sizeof(Object::Vertex), object.vertices.data());
-	indices.upload(object.faces.size() * sizeof(unsigned short), object.faces.data());
+	indices.upload(object.index_bytes(), object.index_data());
 
 
 	glBindVertexArray(vao);
@@ -1429,8 +1433,9 @@ void render::immediate(
 	device_instance_data.upload(host_instance_data.size(), host_instance_data.data());
 
 	glBindBuffer(indices.target, indices.buffer);
+	auto index_type = object.wide_indices() ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
 	glDrawElementsInstanced(
-		GL_TRIANGLES, object.faces.size(), GL_UNSIGNED_SHORT, (void*)0, batch.size
+		GL_TRIANGLES, object.index_count(), index_type, (void*)0, batch.size
 	);
 
 	}
@@ -6,6 +6,7 @@
 #include "Math/Rectangle.hpp"
 #include "Math/Matrix.hpp"
 #include "xstd.hpp"
+#include "std/arena.hpp"
 #include "std/vector.hpp"
 
 namespace render {
@@ -29,15 +30,8 @@ namespace render {
 
 	struct Clear_Depth : Order_Base {};
 	struct Camera : Order_Base {
-		union {
-			Rectanglef rec;
-			struct {
-				Vector2f pos;
-				Vector2f frame_size;
-			};
-		};
-
-		Camera() {};
+		Vector2f pos;
+		Vector2f frame_size;
 	};
 	struct Pop_Camera : Order_Base {};
 
@@ -86,16 +80,9 @@ namespace render {
 
 	
 	struct Rectangle : Order_Base {
-		union {
-			Rectanglef rec;
-			struct {
-				Vector2f pos;
-				Vector2f size;
-			};
-		};
+		Vector2f pos;
+		Vector2f size;
 		Vector4f color;
-
-		Rectangle() {};
 	};
 
 	struct Ring : Order_Base {
@@ -165,22 +152,14 @@ namespace render {
 		std::uint32_t style_mask = 0;
 	};
 	struct Sprite : Order_Base {
-		union {
-			Rectanglef rec;
-			struct {
-				Vector2f pos;
-				Vector2f size;
-			};
-		};
+		Vector2f pos;
+		Vector2f size;
 		Vector2f origin = {};
 		float rotation = 0.f;
 		Vector4f color = V4F(1);
 		Rectanglef texture_rect = {V2F(0), V2F(1)};
 		size_t texture = 0;
 		size_t shader = 0;
-
-		// Need to shut up deleted implictly default constructor.
-		Sprite() { rec = {}; }
 	};
 
 	struct World_Sprite : Order_Base {
@@ -199,27 +178,20 @@ namespace render {
 		sum_type(Order, ORDER_LIST);
 		sum_type_base(Order_Base);
 	};
+}
+XSTD_TRIVIALLY_RELOCATABLE(render::Order);
+namespace render {
 
-
+	// Everything in there lives in the frame arena of the thread that renders, clear has to be
+	// called before that arena is reset.
 	struct Orders {
-		xstd::vector<Order> commands;
-
-		size_t frame_ptr = 0;
-		xstd::vector<std::uint8_t> frame_data;
-
-		Orders() noexcept {
-			frame_data.resize(100'000, 0);
-		}
+		xstd::frame_vector<Order> commands;
 
 		void push(Order o) noexcept;
 		void push(Order o, float z) noexcept;
 
 		void reserve(size_t n) noexcept { commands.reserve(n); }
-		void clear() noexcept {
-			commands.clear();
-			memset(frame_data.data(), 0, frame_data.size());
-			frame_ptr = 0;
-		}
+		void clear() noexcept { commands = {}; }
 
 		auto begin() noexcept -> auto {
 			return std::begin(commands);
@@ -228,12 +200,11 @@ namespace render {
 			return std::end(commands);
 		}
 
+		// A copy of str that lasts until the end of the frame.
 		char* string(const char* str) noexcept {
-			char* ptr = (char*)frame_data.data() + frame_ptr;
-			while (*str && frame_ptr < frame_data.size()) {
-				frame_data[frame_ptr++] = *(str++);
-			}
-			frame_data[frame_ptr++] = 0;
+			size_t n = strlen(str) + 1;
+			auto ptr = xstd::frame_arena().allocate<char>(n);
+			memcpy(ptr, str, n);
 			return ptr;
 		}
 
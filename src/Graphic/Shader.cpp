@@ -6,15 +6,6 @@
 #include "OS/file.hpp"
 #include "OS/OpenGL.hpp"
 
-namespace xstd {
-	template<>
-	struct hash<std::string> {
-		unsigned long long operator()(const std::string& x) noexcept {
-			return std::hash<std::string>()(x);
-		}
-	};
-}
-
 std::optional<Shader> Shader::create_shader(
 	std::filesystem::path vertex
 ) noexcept {
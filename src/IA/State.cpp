@@ -7,8 +7,8 @@ Game_Input_State extract_input(const Game& game, size_t player_id, size_t board_
 	auto& player = game.players[player_id];
 
 	for (size_t i = 0; i < board.tile_size; ++i) {
-		for (auto& x : board.unit_id_by_tile[i]) {
-			state.board_state[i][(size_t)board.units.id(x).kind] += 1;
+		for (size_t k = 0; k < Unit::Kind::Count; ++k) {
+			state.board_state[i][k] += board.unit_kind_count(i, (Unit::Kind)k);
 		}
 		state.board_state[i][Unit::Kind::Count + (size_t)board.tiles[i].kind] += 1;
 	}
@@ -33,7 +33,7 @@ void apply_output(Game& game, Game_Output_State out, size_t player_id, size_t bo
 	tower->tile_pos.x = (size_t)std::roundf(out.place_x * board.size.x);
 	tower->tile_pos.y = (size_t)std::roundf(out.place_y * board.size.y);
 
-	if (player.ressources.gold >= tower->gold_cost && board.can_place_at(tower->tile_rec)) {
+	if (player.ressources.gold >= tower->gold_cost && board.can_place_at(tower->tile_rec())) {
 		player.ressources.gold -= tower->gold_cost;
 		board.insert_tower(tower);
 	}
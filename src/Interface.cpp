@@ -32,7 +32,8 @@ void Tower_Selection::render(render::Orders& orders) noexcept {
 	if (!pool) return;
 	if (selection.empty()) return;
 
-	rec.rec = zone;
+	rec.pos = zone.pos;
+	rec.size = zone.size;
 	rec.color = {0.0f, 0.15f, 0.15f, 1.0f};
 	orders.push(rec);
 
@@ -215,7 +216,8 @@ void Interface::render(render::Orders& orders) noexcept {
 	render::Sprite sprite;
 	render::Text text;
 
-	rec.rec = action_zone;
+	rec.pos = action_zone.pos;
+	rec.size = action_zone.size;
 	rec.color = { 0.1f, 0.1f, 0.1f, 1.0f };
 	orders.push(rec, 2);
 
@@ -235,7 +237,8 @@ void Interface::render(render::Orders& orders) noexcept {
 		orders.push(rec, 3);
 
 		if (it.texture_id) {
-			sprite.rec = rec.rec;
+			sprite.pos = rec.pos;
+			sprite.size = rec.size;
 			sprite.texture = it.texture_id;
 			sprite.color = { it.ready_percentage, it.ready_percentage, it.ready_percentage, 1 };
 			orders.push(sprite, 4);
@@ -245,7 +248,8 @@ void Interface::render(render::Orders& orders) noexcept {
 	// rectangle selection
 	if (dragging) {
 		rec.color = {0, 1, 0, 0.1f};
-		rec.rec = drag_selection;
+		rec.pos = drag_selection.pos;
+		rec.size = drag_selection.size;
 		orders.push(rec, 2);
 	}
 
@@ -112,7 +112,7 @@ struct Action {
 struct Tower_Selection {
 	Vector2f pos;
 
-	xstd::Pool<Tower>* pool = nullptr;
+	xstd::Stable_Pool<Tower>* pool = nullptr;
 	xstd::vector<size_t> selection;
 
 	static constexpr size_t N = 4;
@@ -5,6 +5,7 @@
 #include "xstd.hpp"
 #include "global.hpp"
 
+#include "Graphic/Mesh_Cache.hpp"
 #include "OS/file.hpp"
 #include "OS/OpenGL.hpp"
 
@@ -12,15 +13,6 @@
 
 using namespace asset;
 
-namespace xstd {
-	template<>
-	struct hash<std::string> {
-		unsigned long long operator()(const std::string& x) noexcept {
-			return std::hash<std::string>()(x);
-		}
-	};
-}
-
 namespace asset {
 	Store_t Store;
 }
@@ -55,7 +47,7 @@ namespace asset {
 	}
 
 	if (loaded) {
-		textures_loaded[std::filesystem::weakly_canonical(path).string()] = k;
+		textures_loaded[xstd::intern(std::filesystem::weakly_canonical(path).string())] = k;
 		return true;
 	}
 	else {
@@ -126,7 +118,7 @@ void Store_t::monitor_path(std::filesystem::path dir) noexcept {
 #define WGL_CONTEXT_MINOR_VERSION_ARB           0x2092
 #define WGL_CONTEXT_PROFILE_MASK_ARB            0x9126
 #define WGL_CONTEXT_CORE_PROFILE_BIT_ARB        0x00000001
-#ifndef WEB
+#ifdef _WIN32
 
 	using wglCreateContextAttribsARB_t = HGLRC (*)(HDC, HGLRC, const int *);
 
@@ -164,8 +156,10 @@ void Store_t::monitor_path(std::filesystem::path dir) noexcept {
 
 				auto size_t = path.parent_path() / (suffixes.front() + path.extension().string());
 
-				auto it = textures_loaded.find(size_t.string());
-				
+				// A path never interned can't be a loaded texture, no need to add it.
+				auto key = xstd::find_interned(size_t.string());
+				auto it = key ? textures_loaded.find(*key) : END(textures_loaded);
+
 				if (it != END(textures_loaded) && textures.contains(it->second)) {
 					auto& asset = textures.at(it->second);
 
@@ -213,10 +207,10 @@ void Store_t::monitor_path(std::filesystem::path dir) noexcept {
 
 			for (auto& [_, x] : objects) {
 				if (std::filesystem::canonical(x.path) == path) {
-					auto new_obj = Object::load_from_file(path);
+					auto new_obj = mesh::load_object(path);
 					if (!new_obj) {
 						auto str = path.string();
-						printf("Failed to hot reload dll %s.\n", str.c_str());
+						printf("Failed to hot reload object %s.\n", str.c_str());
 						continue;
 					}
 					x.asset = std::move(*new_obj);
@@ -474,7 +468,7 @@ void Store_t::load_from_config(std::filesystem::path config_path) noexcept {
 	return objects.at(k).asset;
 }
 [[nodiscard]] bool Store_t::load_object(size_t k, std::filesystem::path path) noexcept {
-	auto opt = Object::load_from_file(path);
+	auto opt = mesh::load_object(path);
 	if (!opt) return false;
 
 	Asset_Object obj;
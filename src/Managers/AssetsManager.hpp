@@ -5,7 +5,8 @@
 #include <optional>
 #include <memory>
 
-#include "std/unordered_map.hpp"
+#include "std/interned.hpp"
+#include "std/swiss_map.hpp"
 #include "std/int.hpp"
 
 #include "Graphic/Font.hpp"
@@ -147,16 +148,17 @@ namespace asset {
 		bool stop{ false };
 		std::atomic<bool> ready = false;
 
-		xstd::unordered_map<std::string, uint64_t> textures_loaded;
+		// Keyed by canonical path.
+		xstd::swiss_map<xstd::Interned, uint64_t> textures_loaded;
 
-		xstd::unordered_map<uint64_t, Asset_DLL> dlls;
-		xstd::unordered_map<uint64_t, Asset_Font> fonts;
-		xstd::unordered_map<uint64_t, Asset_Sound> sounds;
-		xstd::unordered_map<uint64_t, Asset_Object> objects;
-		xstd::unordered_map<uint64_t, Asset_Shader> shaders;
-		xstd::unordered_map<uint64_t, Asset_Texture> textures;
+		xstd::swiss_map<uint64_t, Asset_DLL> dlls;
+		xstd::swiss_map<uint64_t, Asset_Font> fonts;
+		xstd::swiss_map<uint64_t, Asset_Sound> sounds;
+		xstd::swiss_map<uint64_t, Asset_Object> objects;
+		xstd::swiss_map<uint64_t, Asset_Shader> shaders;
+		xstd::swiss_map<uint64_t, Asset_Texture> textures;
 
-		xstd::unordered_map<std::string, uint64_t> texture_string_map;
+		xstd::swiss_map<xstd::Interned, uint64_t> texture_string_map;
 
 		[[nodiscard]] Texture* get_normal(size_t k) const noexcept;
 		[[nodiscard]] Texture& get_albedo(size_t k) noexcept;
@@ -449,13 +449,13 @@ Input_Info get_new_frame_input(const Input_Record& records, double dt) noexcept
 	if (length < dead_range) {
 		new_record.left_joystick = {};
 	}
-	new_record.left_joystick.applyCW([](auto x) { return std::powf(x, 1); });
+	new_record.left_joystick.applyCW([](auto x) { return std::pow(x, 1.f); });
 
 	length = new_record.right_joystick.length();
 	if (length < dead_range) {
 		new_record.right_joystick = {};
 	}
-	new_record.right_joystick.applyCW([](auto x) { return std::powf(x, 1); });
+	new_record.right_joystick.applyCW([](auto x) { return std::pow(x, 1.f); });
 
 	for (size_t i = 0; i < io::Controller::Count; ++i) {
 		auto pressed = (bool)(state.buttons_mask & io::map_controller((io::Controller::Button)i));
@@ -53,7 +53,7 @@ struct Matrix {
 	static Matrix<4, 4, float> rotate(Vector3f a, Vector3f b) noexcept {
 		auto v = cross(a, b).normalize();
 		auto c = a.dot(b);
-		return Matrix<4, 4, float>::rotation(v, -std::acosf(c));
+		return Matrix<4, 4, float>::rotation(v, -std::acos(c));
 	}
 
 	template<size_t N = R>
@@ -421,7 +421,7 @@ using Matrix4 = Matrix<4, 4, T>;
 using Matrix4f = Matrix4<float>;
 
 inline Matrix4f perspective(float fov, float ratio, float f, float n) noexcept {
-	float uw = 1.f / std::tanf(fov / 2);
+	float uw = 1.f / std::tan(fov / 2);
 	float uh = uw * ratio;
 
 	Matrix4f matrix;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <math.h>
 #include <type_traits>
 #include "std/int.hpp"
 #include "dyn_struct.hpp"
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <type_traits>
+
+// Base of what a Cow_Ptr points to, the count is in the object itself. Atomic when the object
+// can be shared between threads.
+template<bool Atomic = false>
+struct Ref_Counted {
+	Ref_Counted() noexcept = default;
+	// A copy is a new object, only the one who made it points to it.
+	Ref_Counted(const Ref_Counted&) noexcept {}
+	Ref_Counted& operator=(const Ref_Counted&) noexcept { return *this; }
+
+	void acquire() const noexcept {
+		if constexpr (Atomic) refs.fetch_add(1, std::memory_order_relaxed);
+		else                  refs++;
+	}
+	// True when it was the last one.
+	bool release() const noexcept {
+		if constexpr (Atomic) return refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+		else                  return --refs == 0;
+	}
+	bool unique() const noexcept { return refs == 1; }
+
+	mutable std::conditional_t<Atomic, std::atomic<std::uint32_t>, std::uint32_t> refs = 1;
+};
+
+// ValuePtr that shares instead of copying: a copy is a new reference to the same T, and the
+// first write through a shared one gives it its own copy first. Reading is through const,
+// writing through write().
+// T derives from Ref_Counted. If it has a clone() const, that's what makes the copy, so a
+// Cow_Ptr<Base> can point to derived types (Base then needs a virtual destructor).
+template<typename T>
+class Cow_Ptr {
+public:
+
+	constexpr Cow_Ptr() noexcept {}
+	~Cow_Ptr() noexcept { reset(); }
+
+	// Takes the reference ptr was made with.
+	constexpr Cow_Ptr(T* ptr) noexcept : ptr(ptr) {}
+
+	Cow_Ptr(const Cow_Ptr<T>& other) noexcept : ptr(other.ptr) {
+		if (ptr) ptr->acquire();
+	}
+	constexpr Cow_Ptr(Cow_Ptr<T>&& other) noexcept : ptr(other.ptr) {
+		other.ptr = nullptr;
+	}
+
+	Cow_Ptr<T>& operator=(const Cow_Ptr<T>& other) noexcept {
+		if (other.ptr) other.ptr->acquire();
+		reset();
+		ptr = other.ptr;
+		return *this;
+	}
+	Cow_Ptr<T>& operator=(Cow_Ptr<T>&& other) noexcept {
+		if (this == &other) return *this;
+		reset();
+		ptr = other.ptr;
+		other.ptr = nullptr;
+		return *this;
+	}
+
+	constexpr operator bool() const noexcept {
+		return ptr != nullptr;
+	}
+
+	constexpr const T& operator*() const noexcept {
+		return *ptr;
+	}
+	constexpr const T* operator->() const noexcept {
+		return ptr;
+	}
+	constexpr const T* get() const noexcept {
+		return ptr;
+	}
+
+	T& write() noexcept {
+		if (!ptr->unique()) {
+			T* copy = nullptr;
+			if constexpr (has_clone<T>::value) copy = ptr->clone();
+			else                               copy = new T(*ptr);
+			reset();
+			ptr = copy;
+		}
+		return *ptr;
+	}
+
+	bool unique() const noexcept { return ptr && ptr->unique(); }
+
+	void reset() noexcept {
+		if (ptr && ptr->release()) delete ptr;
+		ptr = nullptr;
+	}
+
+private:
+	template<typename, typename = void>
+	struct has_clone : std::false_type {};
+
+	template<typename V>
+	struct has_clone<V, std::void_t<decltype(std::declval<const V&>().clone())>> :
+		std::true_type {};
+
+	T* ptr{ nullptr };
+};
@@ -1,8 +1,21 @@
 #include "OS/Process.hpp"
 
+#include <emscripten/heap.h>
+#include <stdio.h>
+
 size_t get_process_id() noexcept {
 	return 0;
 }
 size_t get_thread_id() noexcept {
 	return 0;
-}
\ No newline at end of file
+}
+size_t get_peak_memory_usage() noexcept {
+	// The wasm heap only ever grows.
+	return emscripten_get_heap_size();
+}
+std::string get_symbol_name(void* address, bool) noexcept {
+	// Wasm has no symbols at runtime, the address can be looked up in the .map.
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%p", address);
+	return buffer;
+}
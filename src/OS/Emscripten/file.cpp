@@ -2,9 +2,13 @@
 
 #include <OS/file.hpp>
 
+#include <fcntl.h>
 #include <stdio.h>
 #include <string>
 #include <optional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "xstd.hpp"
 #include "std/vector.hpp"
@@ -46,6 +50,28 @@ file::read_whole_file(const std::filesystem::path& path) noexcept {
 	return bytes;
 }
 
+file::Mapped_File::~Mapped_File() noexcept {
+	if (data) munmap((void*)data, size);
+}
+
+// The browser has no real mmap, Emscripten's copies the file in memory. Still one read.
+std::optional<file::Mapped_File> file::map_file(const std::filesystem::path& path) noexcept {
+	int fd = open(path.string().c_str(), O_RDONLY);
+	if (fd < 0) return std::nullopt;
+	defer{ close(fd); };
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) return std::nullopt;
+
+	auto view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (view == MAP_FAILED) return std::nullopt;
+
+	Mapped_File file;
+	file.data = (const std::uint8_t*)view;
+	file.size = (size_t)st.st_size;
+	return file;
+}
+
 bool file::overwrite_file_byte(
 	std::filesystem::path path, const xstd::vector<std::uint8_t>& bytes
 ) noexcept {
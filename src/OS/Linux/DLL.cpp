@@ -0,0 +1,31 @@
+#ifdef __linux__
+
+#include "OS/DLL.hpp"
+
+#include <dlfcn.h>
+
+DLL::DLL(DLL&& other) noexcept {
+	*this = std::move(other);
+}
+DLL& DLL::operator=(DLL&& other) noexcept {
+	this->~DLL();
+	ptr = other.ptr;
+	other.ptr = nullptr;
+	return *this;
+}
+DLL::~DLL() noexcept {
+	if (ptr) dlclose(ptr);
+	ptr = nullptr;
+}
+
+std::optional<DLL> load_dll(std::filesystem::path path) noexcept {
+	DLL dll;
+	dll.ptr = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (!dll.ptr) return std::nullopt;
+	return dll;
+}
+
+void* DLL::get_symbol_(std::string_view name) noexcept {
+	return dlsym(ptr, std::string(name).c_str());
+}
+#endif
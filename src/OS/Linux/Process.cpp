@@ -0,0 +1,60 @@
+#ifdef __linux__
+
+#include "OS/Process.hpp"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+size_t get_process_id() noexcept {
+	return (size_t)getpid();
+}
+
+size_t get_thread_id() noexcept {
+	return (size_t)syscall(SYS_gettid);
+}
+
+size_t get_peak_memory_usage() noexcept {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	// In kilobytes on Linux.
+	return (size_t)usage.ru_maxrss * 1024;
+}
+
+// Only what's in the dynamic symbol table, the executable has to be linked with -rdynamic
+// for its own functions to be in it. Static functions aren't, they are module+offset.
+std::string get_symbol_name(void* address, bool offset) noexcept {
+	Dl_info info;
+	if (dladdr(address, &info) && info.dli_sname) {
+		int status = 0;
+		char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+		std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+		free(demangled);
+		if (!offset) return name;
+
+		char hex[32];
+		snprintf(hex, sizeof(hex), "+0x%zx", (size_t)address - (size_t)info.dli_saddr);
+		return name + hex;
+	}
+
+	char buffer[64];
+	if (dladdr(address, &info) && info.dli_fname) {
+		auto module = strrchr(info.dli_fname, '/');
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"%s+0x%zx",
+			module ? module + 1 : info.dli_fname,
+			(size_t)((char*)address - (char*)info.dli_fbase)
+		);
+	} else {
+		snprintf(buffer, sizeof(buffer), "%p", address);
+	}
+	return buffer;
+}
+#endif
@@ -0,0 +1,30 @@
+#ifdef __linux__
+
+#include "OS/RealTimeIO.hpp"
+
+// Only the headless build runs here, there's no window to get input from: nothing is ever
+// pressed.
+Vector2f io::get_mouse_pos() noexcept {
+	return {};
+}
+
+io::Keyboard_State io::get_keyboard_state() noexcept {
+	return {};
+}
+io::Controller_State io::get_controller_state(size_t i) noexcept {
+	return {};
+}
+size_t io::map_key(size_t x) noexcept {
+	return 0;
+}
+size_t io::map_mouse(size_t x) noexcept {
+	return 0;
+}
+size_t io::map_controller(size_t x) noexcept {
+	return 0;
+}
+
+bool io::is_window_focused() noexcept {
+	return false;
+}
+#endif
@@ -0,0 +1,134 @@
+#ifdef __linux__
+
+#include <OS/file.hpp>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string>
+#include <optional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "xstd.hpp"
+#include "std/vector.hpp"
+
+std::optional<std::string>
+file::read_whole_text(const std::filesystem::path& path) noexcept {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file) return std::nullopt;
+	defer{ fclose(file); };
+
+	fseek(file, 0, SEEK_END);
+	auto len = ftell(file);
+	rewind(file);
+	if (len <= 0) return std::nullopt;
+
+	std::string bytes;
+	bytes.resize((size_t)len);
+	if (fread(bytes.data(), 1, bytes.size(), file) != bytes.size()) return std::nullopt;
+
+	return bytes;
+}
+
+std::optional<xstd::vector<std::uint8_t>>
+file::read_whole_file(const std::filesystem::path& path) noexcept {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file) return std::nullopt;
+	defer{ fclose(file); };
+
+	fseek(file, 0, SEEK_END);
+	auto len = ftell(file);
+	rewind(file);
+	if (len < 0) return std::nullopt;
+
+	xstd::vector<std::uint8_t> bytes;
+	bytes.resize((size_t)len);
+	if (fread(bytes.data(), 1, bytes.size(), file) != bytes.size()) return std::nullopt;
+
+	return bytes;
+}
+
+size_t file::get_file_size(const std::filesystem::path& path) noexcept {
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) return 0;
+	return (size_t)st.st_size;
+}
+
+file::Mapped_File::~Mapped_File() noexcept {
+	if (data) munmap((void*)data, size);
+}
+
+std::optional<file::Mapped_File> file::map_file(const std::filesystem::path& path) noexcept {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) return std::nullopt;
+	defer{ close(fd); };
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) return std::nullopt;
+
+	auto view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (view == MAP_FAILED) return std::nullopt;
+
+	Mapped_File file;
+	file.data = (const std::uint8_t*)view;
+	file.size = (size_t)st.st_size;
+	return file;
+}
+
+bool file::overwrite_file_byte(
+	std::filesystem::path path, const xstd::vector<std::uint8_t>& bytes
+) noexcept {
+	FILE* f = fopen(path.c_str(), "wb");
+	if (!f) return false;
+	defer{ fclose(f); };
+
+	return fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+}
+
+bool file::overwrite_file(const std::filesystem::path& path, std::string_view str) noexcept {
+	FILE* f = fopen(path.c_str(), "wb");
+	if (!f) return false;
+	defer{ fclose(f); };
+
+	return fwrite(str.data(), 1, str.size(), f) == str.size();
+}
+
+// Only the headless build runs here, there's no one to show a dialog to.
+void file::open_file_async(
+	std::function<void(OpenFileResult)>&& callback, OpenFileOpts opts
+) noexcept {
+	printf("Can't browse file on Linux.\n");
+}
+
+void file::open_dir_async(
+	std::function<void(std::optional<std::filesystem::path>)>&& callback
+) noexcept {
+	printf("Can't browse directory on Linux.\n");
+}
+std::optional<std::filesystem::path> file::open_dir() noexcept {
+	printf("Can't browse directory on Linux.\n");
+	return std::nullopt;
+}
+file::OpenFileResult file::open_file(OpenFileOpts opts) noexcept {
+	OpenFileResult result;
+	result.error_code = 558;
+	return result;
+}
+
+void file::monitor_file(std::filesystem::path path, std::function<bool()> f) noexcept {
+	printf("Can't use monitor operation on Linux.\n");
+}
+void file::monitor_dir(
+	std::filesystem::path dir, std::function<bool(std::filesystem::path)> f
+) noexcept {
+	printf("Can't use monitor operation on Linux.\n");
+}
+void file::monitor_dir(
+	std::function<void()> init_thread,
+	std::filesystem::path dir,
+	std::function<bool(std::filesystem::path)> f
+) noexcept {
+	printf("Can't use monitor operation on Linux.\n");
+}
+#endif
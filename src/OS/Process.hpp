@@ -1,5 +1,14 @@
 #pragma once
+#include <string>
+
 #include "std/int.hpp"
 
 extern size_t get_process_id() noexcept;
-extern size_t get_thread_id() noexcept;
\ No newline at end of file
+extern size_t get_thread_id() noexcept;
+
+// In bytes, the most the process ever had resident.
+extern size_t get_peak_memory_usage() noexcept;
+
+// function+offset of address, or the address itself when there are no symbols to know. Without
+// the offset every address in a function gets the same name, to group by function.
+extern std::string get_symbol_name(void* address, bool offset = true) noexcept;
@@ -1,5 +1,10 @@
 #include "OS/Process.hpp"
 #include "Windows.h"
+#include "Psapi.h"
+#include "dbghelp.h"
+
+#include <mutex>
+#include <stdio.h>
 
 size_t get_process_id() noexcept {
 	return (size_t)GetCurrentProcessId();
@@ -8,3 +13,37 @@ size_t get_process_id() noexcept {
 size_t get_thread_id() noexcept {
 	return (size_t)GetCurrentThreadId();
 }
+
+size_t get_peak_memory_usage() noexcept {
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return (size_t)counters.PeakWorkingSetSize;
+}
+
+std::string get_symbol_name(void* address, bool offset) noexcept {
+	// DbgHelp is single threaded.
+	static std::mutex mutex;
+	std::lock_guard lock(mutex);
+
+	auto handle = GetCurrentProcess();
+	static auto initialized = SymInitialize(handle, nullptr, true);
+
+	char buffer[sizeof(SYMBOL_INFO) + 256] = {};
+	PSYMBOL_INFO symbol = (PSYMBOL_INFO)buffer;
+	symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+	symbol->MaxNameLen = 256;
+
+	DWORD64 displacement = 0;
+	if (initialized && SymFromAddr(handle, (DWORD64)address, &displacement, symbol)) {
+		std::string name(symbol->Name, symbol->NameLen);
+		if (!offset) return name;
+
+		char hex[32];
+		snprintf(hex, sizeof(hex), "+0x%llx", (unsigned long long)displacement);
+		return name + hex;
+	}
+
+	char hex[32];
+	snprintf(hex, sizeof(hex), "%p", address);
+	return hex;
+}
@@ -58,6 +58,41 @@ size_t file::get_file_size(const std::filesystem::path& path) noexcept {
 	return large_int.QuadPart;
 }
 
+file::Mapped_File::~Mapped_File() noexcept {
+	if (data) UnmapViewOfFile(data);
+}
+
+std::optional<file::Mapped_File> file::map_file(const std::filesystem::path& path) noexcept {
+	auto handle = CreateFile(
+		path.native().c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr
+	);
+	if (handle == INVALID_HANDLE_VALUE) return std::nullopt;
+	defer{ CloseHandle(handle); };
+
+	LARGE_INTEGER large_int;
+	GetFileSizeEx(handle, &large_int);
+	if (large_int.QuadPart == 0) return std::nullopt;
+
+	auto mapping = CreateFileMapping(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) return std::nullopt;
+	// The view keeps the mapping alive.
+	defer{ CloseHandle(mapping); };
+
+	auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) return std::nullopt;
+
+	Mapped_File file;
+	file.data = (const std::uint8_t*)view;
+	file.size = (size_t)large_int.QuadPart;
+	return file;
+}
+
 
 std::optional<xstd::vector<std::uint8_t>>
 file::read_whole_file(const std::filesystem::path& path) noexcept {
@@ -15,6 +15,33 @@ namespace file {
 		read_whole_file(const std::filesystem::path& path) noexcept;
 	[[nodiscard]] extern size_t get_file_size(const std::filesystem::path& path) noexcept;
 
+	// A whole file mapped read only, unmapped when it goes. Nothing is read before it's
+	// touched, and a parser can look at it in place instead of going through a copy.
+	struct Mapped_File {
+		const std::uint8_t* data = nullptr;
+		size_t size = 0;
+
+		Mapped_File() noexcept = default;
+		Mapped_File(const Mapped_File&) = delete;
+		Mapped_File& operator=(const Mapped_File&) = delete;
+		Mapped_File(Mapped_File&& other) noexcept { *this = std::move(other); }
+		Mapped_File& operator=(Mapped_File&& other) noexcept {
+			if (this == &other) return *this;
+			this->~Mapped_File();
+			data = other.data;
+			size = other.size;
+			other.data = nullptr;
+			other.size = 0;
+			return *this;
+		}
+		~Mapped_File() noexcept;
+
+		std::string_view view() const noexcept { return { (const char*)data, size }; }
+	};
+	// nullopt for an empty file too, there's nothing to map.
+	[[nodiscard]] extern std::optional<Mapped_File>
+		map_file(const std::filesystem::path& path) noexcept;
+
 	[[nodiscard]] extern bool overwrite_file_byte(
 		std::filesystem::path path, const xstd::vector<std::uint8_t>& bytes
 	) noexcept;
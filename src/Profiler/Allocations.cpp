@@ -0,0 +1,207 @@
+#include "Allocations.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+#include "OS/Process.hpp"
+#include "Profiler/Tracer.hpp"
+
+std::atomic<bool> allocation_tracking = false;
+
+namespace {
+
+struct Scope_Allocations {
+	const char* name = nullptr;
+
+	size_t count = 0;
+	size_t bytes = 0;
+	size_t live = 0;
+	size_t peak = 0;
+
+	size_t frame = SIZE_MAX;
+	size_t frame_count = 0;
+	size_t frame_bytes = 0;
+	size_t max_frame_count = 0;
+	size_t max_frame_bytes = 0;
+};
+
+struct Site_Allocations {
+	void* caller = nullptr;
+	std::uint32_t scope = Untracked_Allocation;
+	size_t count = 0;
+	size_t bytes = 0;
+};
+
+struct Allocation_Tables {
+	static constexpr size_t SCOPE_BITS = 8;
+	static constexpr size_t MAX_SCOPE = 1 << SCOPE_BITS;
+	static constexpr size_t MAX_SITE = 4096; // Power of two.
+	// The rest of the bits of an id, never all ones so no id is Untracked_Allocation.
+	static constexpr std::uint32_t MAX_GENERATION = UINT32_MAX >> SCOPE_BITS;
+
+	std::atomic_flag lock = ATOMIC_FLAG_INIT;
+
+	// Bumped by every reset, the ids handed out carry it so that a block allocated before a
+	// reset and freed after it isn't taken out of whatever scope got its index since.
+	std::uint32_t generation = 0;
+	size_t first_frame = 0;
+	size_t dropped_sites = 0;
+
+	size_t scope_count = 0;
+	Scope_Allocations scopes[MAX_SCOPE];
+	Site_Allocations sites[MAX_SITE];
+};
+Allocation_Tables tables;
+
+// The report allocates, and so may whatever the tracker calls.
+thread_local bool inside_tracker = false;
+
+struct Tables_Lock {
+	Tables_Lock() noexcept { while (tables.lock.test_and_set(std::memory_order_acquire)); }
+	~Tables_Lock() noexcept { tables.lock.clear(std::memory_order_release); }
+};
+
+std::uint32_t scope_id(const char* name) noexcept {
+	for (size_t i = 0; i < tables.scope_count; ++i) {
+		auto other = tables.scopes[i].name;
+		if (other == name || strcmp(other, name) == 0) return (std::uint32_t)i;
+	}
+	if (tables.scope_count >= Allocation_Tables::MAX_SCOPE) return Untracked_Allocation;
+
+	tables.scopes[tables.scope_count] = {};
+	tables.scopes[tables.scope_count].name = name;
+	return (std::uint32_t)tables.scope_count++;
+}
+
+Site_Allocations* site(std::uint32_t scope, void* caller) noexcept {
+	size_t h = ((size_t)caller >> 4) * 31 + scope;
+	for (size_t i = 0; i < 16; ++i) {
+		auto& s = tables.sites[(h + i) & (Allocation_Tables::MAX_SITE - 1)];
+		if (s.scope == scope && s.caller == caller) return &s;
+		if (s.scope == Untracked_Allocation) {
+			s.scope = scope;
+			s.caller = caller;
+			return &s;
+		}
+	}
+	return nullptr;
+}
+
+}
+
+std::uint32_t track_allocation(size_t n, void* caller) noexcept {
+	if (!allocation_tracking.load(std::memory_order_relaxed) || inside_tracker) {
+		return Untracked_Allocation;
+	}
+	inside_tracker = true;
+	defer { inside_tracker = false; };
+
+	auto name = current_timed_block ? current_timed_block : "<no scope>";
+	auto frame = current_sample_frame();
+
+	Tables_Lock lock;
+	auto id = scope_id(name);
+	if (id == Untracked_Allocation) return id;
+
+	auto& scope = tables.scopes[id];
+	scope.count++;
+	scope.bytes += n;
+	scope.live += n;
+	scope.peak = std::max(scope.peak, scope.live);
+
+	if (scope.frame != frame) {
+		scope.frame = frame;
+		scope.frame_count = 0;
+		scope.frame_bytes = 0;
+	}
+	scope.frame_count++;
+	scope.frame_bytes += n;
+	scope.max_frame_count = std::max(scope.max_frame_count, scope.frame_count);
+	scope.max_frame_bytes = std::max(scope.max_frame_bytes, scope.frame_bytes);
+
+	if (auto s = site(id, caller)) {
+		s->count++;
+		s->bytes += n;
+	} else {
+		tables.dropped_sites++;
+	}
+	return (tables.generation << Allocation_Tables::SCOPE_BITS) | id;
+}
+
+void track_free(std::uint32_t scope, size_t n) noexcept {
+	if (scope == Untracked_Allocation) return;
+
+	Tables_Lock lock;
+	// Allocated before a reset, it was counted in tables that were forgotten.
+	if ((scope >> Allocation_Tables::SCOPE_BITS) != tables.generation) return;
+	auto& s = tables.scopes[scope & (Allocation_Tables::MAX_SCOPE - 1)];
+	s.live -= std::min(s.live, n);
+}
+
+void reset_allocation_tracking() noexcept {
+	Tables_Lock lock;
+	tables.generation = (tables.generation + 1) % Allocation_Tables::MAX_GENERATION;
+	tables.first_frame = current_sample_frame();
+	tables.dropped_sites = 0;
+	tables.scope_count = 0;
+	for (auto& s : tables.sites) s = {};
+}
+
+dyn_struct allocation_report() noexcept {
+	inside_tracker = true;
+	defer { inside_tracker = false; };
+
+	// Copied so that the lock isn't held while the report allocates.
+	static Allocation_Tables copy;
+	size_t frames = 0;
+	{
+		Tables_Lock lock;
+		copy.scope_count = tables.scope_count;
+		copy.dropped_sites = tables.dropped_sites;
+		std::copy_n(tables.scopes, tables.scope_count, copy.scopes);
+		std::copy_n(tables.sites, Allocation_Tables::MAX_SITE, copy.sites);
+		frames = current_sample_frame() - tables.first_frame;
+	}
+
+	xstd::vector<size_t> scopes;
+	for (size_t i = 0; i < copy.scope_count; ++i) scopes.push_back(i);
+	std::sort(BEG_END(scopes), [] (size_t a, size_t b) {
+		return copy.scopes[a].bytes > copy.scopes[b].bytes;
+	});
+
+	xstd::vector<Site_Allocations> sites;
+
+	dyn_struct report = dyn_struct::structure_t{};
+	report["frames"] = frames;
+	report["dropped_sites"] = copy.dropped_sites;
+	report["scopes"] = dyn_struct::array_t{};
+	for (auto i : scopes) {
+		auto& s = copy.scopes[i];
+
+		dyn_struct x = dyn_struct::structure_t{};
+		x["scope"] = s.name;
+		x["count"] = s.count;
+		x["bytes"] = s.bytes;
+		x["per_frame"] = frames ? (double)s.count / frames : (double)s.count;
+		x["max_frame_count"] = s.max_frame_count;
+		x["max_frame_bytes"] = s.max_frame_bytes;
+		x["live_bytes"] = s.live;
+		x["peak_live_bytes"] = s.peak;
+
+		sites.clear();
+		for (auto& c : copy.sites) if (c.scope == i) sites.push_back(c);
+		std::sort(BEG_END(sites), [] (auto& a, auto& b) { return a.bytes > b.bytes; });
+
+		x["sites"] = dyn_struct::array_t{};
+		for (auto& c : sites) {
+			dyn_struct y = dyn_struct::structure_t{};
+			y["site"] = get_symbol_name(c.caller);
+			y["count"] = c.count;
+			y["bytes"] = c.bytes;
+			x["sites"].push_back(y);
+		}
+
+		report["scopes"].push_back(x);
+	}
+	return report;
+}
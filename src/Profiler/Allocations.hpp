@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "dyn_struct.hpp"
+
+// Who allocates, off by default. An executable that replaces operator new (see
+// Entry/headless_main.cpp) calls track_allocation/track_free, every allocation made while
+// tracking is on is charged to the innermost TIMED_BLOCK of its thread and to the address that
+// called operator new. Per scope it keeps the allocations per frame, the worst frame and the
+// high-water mark of the bytes still alive, to know where a frame arena would pay off.
+// Nothing in here allocates, the tables are fixed and full tables count what they drop.
+
+extern std::atomic<bool> allocation_tracking;
+
+// No scope, returned when tracking is off or the scope table is full.
+constexpr std::uint32_t Untracked_Allocation = UINT32_MAX;
+
+// Returns the scope id to hand back to track_free with the same n. Frees of what was allocated
+// before the last reset are ignored.
+extern std::uint32_t track_allocation(size_t n, void* caller) noexcept;
+extern void track_free(std::uint32_t scope, size_t n) noexcept;
+
+// Forgets everything tracked so far.
+extern void reset_allocation_tracking() noexcept;
+
+// { frames, dropped_sites, scopes: [{ scope, count, bytes, per_frame, max_frame_count,
+//   max_frame_bytes, live_bytes, peak_live_bytes, sites: [{ site, count, bytes }] }] }
+// Scopes and sites sorted by bytes, the biggest first.
+extern dyn_struct allocation_report() noexcept;
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+	#define ALLOCATION_CALLER() _ReturnAddress()
+#else
+	#define ALLOCATION_CALLER() __builtin_return_address(0)
+#endif
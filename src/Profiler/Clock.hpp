@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__EMSCRIPTEN__)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define PROFILER_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_RDTSC
+#endif
+
+// Ticks for the profiler: the time stamp counter where there is one, a few ns to read and
+// monotonic on anything with an invariant TSC. Elsewhere steady_clock nanoseconds.
+inline std::uint64_t profiler_ticks() noexcept {
+#ifdef PROFILER_RDTSC
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+#endif
+}
+
+// Measured once against steady_clock the first time it's asked for.
+extern double profiler_ticks_per_second() noexcept;
+
+inline double ticks_to_ns(std::uint64_t ticks) noexcept {
+	return ticks * (1e9 / profiler_ticks_per_second());
+}
+inline double ticks_to_ms(std::uint64_t ticks) noexcept {
+	return ticks * (1e3 / profiler_ticks_per_second());
+}
@@ -0,0 +1,72 @@
+#include "Counters.hpp"
+
+#include <mutex>
+#include <string.h>
+
+#include "Profiler/Tracer.hpp"
+#include "std/unordered_map.hpp"
+
+static_assert(Counter_Registry::MAX_FRAME_RECORD == Sample_Log::MAX_FRAME_RECORD);
+
+Counter_Registry counter_registry;
+
+size_t register_counter(const char* name, Counter_Kind kind) noexcept {
+	static std::mutex mutex;
+	std::lock_guard lock(mutex);
+
+	auto& r = counter_registry;
+	size_t n = r.count.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < n; ++i) if (strcmp(r.names[i], name) == 0) return i;
+	if (n >= Counter_Registry::MAX_COUNTER) return Counter_Registry::MAX_COUNTER;
+
+	r.names[n] = name;
+	r.kinds[n] = kind;
+	r.values[n] = 0;
+	r.count.store(n + 1, std::memory_order_release);
+	return n;
+}
+
+void snapshot_counters(size_t frame) noexcept {
+#ifdef PROFILER
+	// The hashmaps count on their own, in a thread_local: only this thread's lookups are seen.
+	auto& probes = zedland::hashmap_probe_stats;
+	PROFILER_COUNTER_ADD("hashmap lookups", probes.lookups);
+	PROFILER_COUNTER_ADD("hashmap probes", probes.probes);
+	probes = {};
+#endif
+
+	auto& r = counter_registry;
+	size_t n = r.count.load(std::memory_order_acquire);
+	size_t slot = frame % Counter_Registry::MAX_FRAME_RECORD;
+
+	for (size_t i = 0; i < n; ++i) {
+		if (r.kinds[i] == Counter_Kind::Counter)
+			r.history[slot][i] = r.values[i].exchange(0, std::memory_order_relaxed);
+		else
+			r.history[slot][i] = r.values[i].load(std::memory_order_relaxed);
+	}
+	// Shifted by one so that a zeroed slot isn't frame 0.
+	r.history_frame[slot].store(frame + 1, std::memory_order_release);
+
+	// Counter names are only interned for the trace the first time they are emitted.
+	static std::uint32_t trace_names[Counter_Registry::MAX_COUNTER];
+	static size_t trace_names_count = 0;
+	for (; trace_names_count < n; ++trace_names_count) {
+		trace_names[trace_names_count] = Tracer::intern(r.names[trace_names_count]);
+	}
+
+	auto now = trace_now();
+	for (size_t i = 0; i < n; ++i) {
+		Tracer::get().record(
+			Trace_Category::Counter, trace_names[i], now, (std::uint64_t)r.history[slot][i]
+		);
+	}
+}
+
+std::optional<std::int64_t> counter_value(size_t frame, size_t id) noexcept {
+	auto& r = counter_registry;
+	size_t slot = frame % Counter_Registry::MAX_FRAME_RECORD;
+	if (id >= r.count.load(std::memory_order_acquire)) return std::nullopt;
+	if (r.history_frame[slot].load(std::memory_order_acquire) != frame + 1) return std::nullopt;
+	return r.history[slot][id];
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Named numbers recorded once per frame next to the Timed_Block samples, to know why a frame
+// was slow and not only where. A counter is summed over the frame and starts back from 0, a
+// gauge keeps the last value it was set to. Everything is preallocated, a counter costs one
+// relaxed atomic add. Kept out of anything else so low level code (containers) can use it.
+
+enum class Counter_Kind : std::uint8_t {
+	Counter = 0,
+	Gauge
+};
+
+struct Counter_Registry {
+	static constexpr size_t MAX_COUNTER = 64;
+	static constexpr size_t MAX_FRAME_RECORD = 200;
+
+	std::atomic<size_t> count = 0;
+	const char* names[MAX_COUNTER] = {};
+	Counter_Kind kinds[MAX_COUNTER] = {};
+	std::atomic<std::int64_t> values[MAX_COUNTER] = {};
+
+	std::int64_t history[MAX_FRAME_RECORD][MAX_COUNTER] = {};
+	std::atomic<size_t> history_frame[MAX_FRAME_RECORD] = {};
+};
+extern Counter_Registry counter_registry;
+
+// Same name, same id. Past MAX_COUNTER names, the returned id is ignored by everyone.
+extern size_t register_counter(const char* name, Counter_Kind kind) noexcept;
+
+inline void counter_add(size_t id, std::int64_t n) noexcept {
+	if (id >= Counter_Registry::MAX_COUNTER) return;
+	counter_registry.values[id].fetch_add(n, std::memory_order_relaxed);
+}
+inline void gauge_set(size_t id, std::int64_t v) noexcept {
+	if (id >= Counter_Registry::MAX_COUNTER) return;
+	counter_registry.values[id].store(v, std::memory_order_relaxed);
+}
+
+// Keeps the values of every counter for frame and resets the counters, called by
+// next_sample_frame. Also emits them as counter tracks when a trace session is running.
+extern void snapshot_counters(size_t frame) noexcept;
+
+// Value of a counter at the end of frame, if that frame is still in the history.
+extern std::optional<std::int64_t> counter_value(size_t frame, size_t id) noexcept;
+
+#ifdef PROFILER
+#define PROFILER_COUNTER_ADD(name, n) do {\
+	static const size_t profiler_counter_id = register_counter(name, Counter_Kind::Counter);\
+	counter_add(profiler_counter_id, (std::int64_t)(n));\
+} while (0)
+#define PROFILER_GAUGE_SET(name, v) do {\
+	static const size_t profiler_counter_id = register_counter(name, Counter_Kind::Gauge);\
+	gauge_set(profiler_counter_id, (std::int64_t)(v));\
+} while (0)
+#else
+#define PROFILER_COUNTER_ADD(name, n)
+#define PROFILER_GAUGE_SET(name, v)
+#endif
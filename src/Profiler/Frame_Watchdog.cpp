@@ -0,0 +1,69 @@
+#include "Frame_Watchdog.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+
+void Frame_Watchdog::end_frame(
+	const std::function<dyn_struct()>& snapshot, std::optional<double> frame_ms
+) noexcept {
+	auto now = profiler_ticks();
+	defer { last_end = now; };
+	if (!enabled || captures >= max_captures) return;
+
+	// The frame that just ended, next_sample_frame already moved on.
+	auto frame = current_sample_frame() - 1;
+
+	if (pending != SIZE_MAX) {
+		if (frame >= pending + after()) capture();
+		return;
+	}
+
+	if (!frame_ms) {
+		if (last_end == 0) return;
+		frame_ms = ticks_to_ms(now - last_end);
+	}
+	if (*frame_ms <= budget_ms) return;
+
+	pending = frame;
+	pending_ms = *frame_ms;
+	pending_snapshot = snapshot ? snapshot() : dyn_struct{};
+	if (after() == 0) capture();
+}
+
+void Frame_Watchdog::capture() noexcept {
+	defer {
+		pending = SIZE_MAX;
+		pending_snapshot = {};
+		captures++;
+	};
+
+	// The oldest frame in the logs is about to be recycled, one is kept as a margin.
+	auto before = std::min(frames_before, Sample_Log::MAX_FRAME_RECORD - after() - 2);
+	auto first = pending > before ? pending - before : 0;
+	auto last = pending + after();
+
+	std::error_code ec;
+	std::filesystem::create_directories(dir, ec);
+
+	auto name = "hitch_" + std::to_string(captures);
+	auto trace = dir / (name + ".json");
+	if (!write_frames_to_chrome_json(first, last, trace, pending)) {
+		printf("Can't write %s\n", trace.generic_string().c_str());
+		return;
+	}
+
+	dyn_struct board = dyn_struct::structure_t{};
+	board["frame"] = pending;
+	board["frame_ms"] = pending_ms;
+	board["budget_ms"] = budget_ms;
+	board["snapshot"] = pending_snapshot;
+	save_to_json_file(board, dir / (name + ".board.json"));
+
+	printf(
+		"Frame %zu took %.2lf ms, over the %.2lf ms budget, written to %s\n",
+		pending,
+		pending_ms,
+		budget_ms,
+		trace.generic_string().c_str()
+	);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <optional>
+
+#include "dyn_struct.hpp"
+
+#include "Profiler/Tracer.hpp"
+
+// Hitches that happen once in a while are gone by the time someone opens the profiler. The
+// watchdog times every frame and when one goes over budget_ms, it waits frames_after more
+// frames and writes every frame from frames_before before the slow one to frames_after after
+// it, from the sample logs, as a Chrome trace in dir, hitch_<n>.json. What snapshot returned
+// on the slow frame goes next to it in hitch_<n>.board.json.
+// The sample logs only keep Sample_Log::MAX_FRAME_RECORD frames, that's as far back as it goes,
+// and frames_after is capped so that the slow frame is still in there.
+struct Frame_Watchdog {
+	bool enabled = false;
+
+	double budget_ms = 1000 / 30.0;
+	size_t frames_before = 120;
+	size_t frames_after = 10;
+
+	// Past that many captures the watchdog stops, a game that hitches every second would fill
+	// the disk.
+	size_t max_captures = 16;
+	size_t captures = 0;
+
+	std::filesystem::path dir = "hitches";
+
+	// To call once per frame, right after next_sample_frame. The frame time is the time since
+	// the last call, unless frame_ms is given.
+	void end_frame(
+		const std::function<dyn_struct()>& snapshot, std::optional<double> frame_ms = std::nullopt
+	) noexcept;
+
+private:
+	std::uint64_t last_end = 0;
+
+	size_t pending = SIZE_MAX;
+	double pending_ms = 0;
+	dyn_struct pending_snapshot;
+
+	void capture() noexcept;
+
+	size_t after() const noexcept {
+		return std::min(frames_after, Sample_Log::MAX_FRAME_RECORD - 2);
+	}
+};
@@ -0,0 +1,171 @@
+#include "Profile_Tree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+size_t Profile_Tree::child(size_t parent, const char* name) noexcept {
+	auto& siblings = parent == SIZE_MAX ? roots : nodes[parent].children;
+	for (auto& x : siblings) {
+		auto other = nodes[x].name;
+		if (other == name || strcmp(other, name) == 0) return x;
+	}
+
+	Node n;
+	n.name = name;
+	n.parent = parent;
+	n.window.resize(window_size, 0.f);
+	nodes.push_back(std::move(n));
+
+	// nodes might have moved, siblings too.
+	size_t idx = nodes.size() - 1;
+	if (parent == SIZE_MAX) roots.push_back(idx);
+	else                    nodes[parent].children.push_back(idx);
+	return idx;
+}
+
+void Profile_Tree::add_frame(size_t frame) noexcept {
+	scratch.clear();
+	for_each_sample(frame, [&] (const Sample& s) { scratch.push_back(s); });
+
+	// Samples are written when their scope ends, so children come before their parent. Sorted
+	// by start, and the longest first on a tie, a parent is always before what it contains.
+	std::sort(BEG_END(scratch), [] (const Sample& a, const Sample& b) {
+		if (a.thread_id != b.thread_id) return a.thread_id < b.thread_id;
+		if (a.time_start != b.time_start) return a.time_start < b.time_start;
+		return a.time_end > b.time_end;
+	});
+
+	size_t thread = SIZE_MAX;
+	stack.clear();
+	for (auto& s : scratch) {
+		if (s.thread_id != thread) {
+			thread = s.thread_id;
+			stack.clear();
+		}
+		while (!stack.empty() && s.time_start >= stack.back().end) stack.pop_back();
+
+		size_t parent = stack.empty() ? SIZE_MAX : stack.back().node;
+		size_t n = child(parent, s.function_name);
+
+		auto& node = nodes[n];
+		if (node.frame_calls == 0) touched.push_back(n);
+		node.frame_ticks += s.time_end - s.time_start;
+		node.frame_calls++;
+
+		stack.push_back({ n, s.time_end });
+	}
+
+	close_frame();
+}
+
+void Profile_Tree::close_frame() noexcept {
+	for (auto& n : touched) {
+		auto& node = nodes[n];
+		auto ms = ticks_to_ms(node.frame_ticks);
+
+		node.window[node.window_next] = (float)ms;
+		node.window_next = (node.window_next + 1) % window_size;
+		node.frames++;
+		node.calls += node.frame_calls;
+
+		node.frame_ticks = 0;
+		node.frame_calls = 0;
+	}
+	touched.clear();
+	frames++;
+}
+
+Profile_Tree::Stats Profile_Tree::stats(size_t n) const noexcept {
+	auto& node = nodes[n];
+
+	Stats s;
+	size_t count = std::min(node.frames, window_size);
+	if (count == 0) return s;
+
+	std::vector<float> sorted(node.window.data(), node.window.data() + count);
+	std::sort(BEG_END(sorted));
+
+	auto rank = [&] (double p) {
+		size_t i = (size_t)std::ceil(p * count);
+		return (double)sorted[std::clamp<size_t>(i, 1, count) - 1];
+	};
+
+	double sum = 0;
+	for (auto& x : sorted) sum += x;
+	s.mean = sum / count;
+	s.p50 = rank(0.50);
+	s.p95 = rank(0.95);
+	s.p99 = rank(0.99);
+	s.max = sorted.back();
+	return s;
+}
+
+std::string Profile_Tree::path(size_t n) const noexcept {
+	std::string result = nodes[n].name;
+	for (auto p = nodes[n].parent; p != SIZE_MAX; p = nodes[p].parent) {
+		result = std::string(nodes[p].name) + "/" + result;
+	}
+	return result;
+}
+
+dyn_struct Profile_Tree::to_dyn_struct() const noexcept {
+	auto node_to_json = [&] (auto& self, size_t n, size_t depth) -> dyn_struct {
+		auto s = stats(n);
+
+		dyn_struct x = dyn_struct::structure_t{};
+		x["name"] = nodes[n].name;
+		x["path"] = path(n);
+		x["depth"] = depth;
+		x["frames"] = nodes[n].frames;
+		x["calls"] = nodes[n].calls;
+		x["mean"] = s.mean;
+		x["p50"] = s.p50;
+		x["p95"] = s.p95;
+		x["p99"] = s.p99;
+		x["max"] = s.max;
+
+		x["children"] = dyn_struct::array_t{};
+		for (auto& c : nodes[n].children) x["children"].push_back(self(self, c, depth + 1));
+		return x;
+	};
+
+	dyn_struct result = dyn_struct::structure_t{};
+	result["frames"] = frames;
+	result["window"] = window_size;
+	result["nodes"] = dyn_struct::array_t{};
+	for (auto& r : roots) result["nodes"].push_back(node_to_json(node_to_json, r, 0));
+	return result;
+}
+
+bool Profile_Tree::save_csv(const std::filesystem::path& path) const noexcept {
+	FILE* f = fopen(path.generic_string().c_str(), "wb");
+	if (!f) return false;
+	defer { fclose(f); };
+
+	fprintf(f, "path,depth,frames,calls,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n");
+
+	auto write = [&] (auto& self, size_t n, size_t depth) -> void {
+		auto s = stats(n);
+
+		// Function names have commas in them.
+		fputc('"', f);
+		for (auto c : this->path(n)) {
+			if (c == '"') fputc('"', f);
+			fputc(c, f);
+		}
+		fputc('"', f);
+
+		fprintf(
+			f,
+			",%zu,%zu,%zu,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+			depth, nodes[n].frames, nodes[n].calls, s.mean, s.p50, s.p95, s.p99, s.max
+		);
+		for (auto& c : nodes[n].children) self(self, c, depth + 1);
+	};
+	for (auto& r : roots) write(write, r, 0);
+
+	return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <filesystem>
+
+#include "dyn_struct.hpp"
+#include "std/vector.hpp"
+
+#include "Profiler/Tracer.hpp"
+
+// Call tree rebuilt every frame from the nested TIMED_FUNCTION/TIMED_BLOCK samples. A node is a
+// path of names, "Board::update/Units" is not the same node as "Game::update/Units". For every
+// node the time it took in each of the last `window` frames it ran in is kept, to get its
+// percentiles: a spike every 200 frames vanishes in a mean but not in a p99.
+// Frames a node didn't run in aren't counted as 0 ms, its mean and percentiles are per frame it
+// ran in. Something that runs once a second costs what it costs when it runs, and frames counts
+// how often that is.
+struct Profile_Tree {
+	struct Node {
+		const char* name = nullptr;
+		size_t parent = SIZE_MAX;
+		xstd::vector<size_t> children;
+
+		// Rolling window of the per frame totals, in ms.
+		xstd::vector<float> window;
+		size_t window_next = 0;
+
+		size_t frames = 0;
+		size_t calls = 0;
+
+		std::uint64_t frame_ticks = 0;
+		size_t frame_calls = 0;
+	};
+
+	// All over the same window, only a node's frames and calls count the whole run.
+	struct Stats {
+		double mean = 0;
+		double p50 = 0;
+		double p95 = 0;
+		double p99 = 0;
+		double max = 0;
+	};
+
+	xstd::vector<Node> nodes;
+	xstd::vector<size_t> roots;
+	size_t window_size = 600;
+	size_t frames = 0;
+
+	// window_size can't be 0.
+	Profile_Tree(size_t window_size = 600) noexcept : window_size(window_size) {}
+
+	// Folds in every sample of a finished frame.
+	void add_frame(size_t frame) noexcept;
+
+	Stats stats(size_t node) const noexcept;
+	std::string path(size_t node) const noexcept;
+
+	// { frames, window, nodes: [{name, path, depth, frames, calls, mean, p50, p95, p99, max,
+	//   children: [...]}] }
+	dyn_struct to_dyn_struct() const noexcept;
+	// One line per node, parents before their children.
+	bool save_csv(const std::filesystem::path& path) const noexcept;
+
+private:
+	size_t child(size_t parent, const char* name) noexcept;
+	void close_frame() noexcept;
+
+	struct Open {
+		size_t node = 0;
+		std::uint64_t end = 0;
+	};
+
+	xstd::vector<Sample> scratch;
+	xstd::vector<Open> stack;
+	xstd::vector<size_t> touched;
+};
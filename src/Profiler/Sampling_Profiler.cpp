@@ -0,0 +1,180 @@
+#include "Sampling_Profiler.hpp"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+#include "OS/Process.hpp"
+#include "Profiler/Tracer.hpp"
+#include "std/unordered_map.hpp"
+#include "std/vector.hpp"
+
+namespace {
+
+struct Stack_Sample {
+	static constexpr size_t MAX_DEPTH = 48;
+
+	const char* scope = nullptr;
+	// Written last by the signal handler, 0 while the sample isn't complete.
+	std::atomic<std::uint32_t> depth = 0;
+	void* pcs[MAX_DEPTH];
+};
+
+// Big enough for a minute at 1000Hz, past that samples are dropped and counted.
+constexpr size_t MAX_STACK_SAMPLE = 1 << 16;
+
+Stack_Sample* samples = nullptr;
+std::atomic<size_t> sample_count = 0;
+std::atomic<size_t> dropped = 0;
+std::atomic<bool> sampling = false;
+bool handler_installed = false;
+
+// Past this the frame pointer isn't one, it's some register a function without frame pointer
+// used for something else.
+constexpr std::uintptr_t MAX_STACK_WALK = 8 * 1024 * 1024;
+
+void on_sigprof(int, siginfo_t*, void* context) {
+	if (!sampling.load(std::memory_order_relaxed)) return;
+	int saved_errno = errno;
+
+	auto i = sample_count.fetch_add(1, std::memory_order_relaxed);
+	if (i >= MAX_STACK_SAMPLE) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		errno = saved_errno;
+		return;
+	}
+	auto& s = samples[i];
+
+	auto& mc = ((ucontext_t*)context)->uc_mcontext;
+#if defined(__x86_64__)
+	auto pc = (std::uintptr_t)mc.gregs[REG_RIP];
+	auto fp = (std::uintptr_t)mc.gregs[REG_RBP];
+	auto sp = (std::uintptr_t)mc.gregs[REG_RSP];
+#elif defined(__aarch64__)
+	auto pc = (std::uintptr_t)mc.pc;
+	auto fp = (std::uintptr_t)mc.regs[29];
+	auto sp = (std::uintptr_t)mc.sp;
+#else
+	std::uintptr_t pc = 0, fp = 0, sp = 0;
+#endif
+
+	std::uint32_t depth = 0;
+	s.pcs[depth++] = (void*)pc;
+	// Every frame starts with the caller's frame pointer followed by the return address.
+	while (
+		depth < Stack_Sample::MAX_DEPTH &&
+		fp >= sp && fp - sp < MAX_STACK_WALK && fp % sizeof(void*) == 0
+	) {
+		auto frame = (std::uintptr_t*)fp;
+		auto ret = frame[1];
+		if (!ret) break;
+		s.pcs[depth++] = (void*)ret;
+
+		// The stack grows down, going up the callers fp only ever grows.
+		if (frame[0] <= fp) break;
+		fp = frame[0];
+	}
+
+	s.scope = current_timed_block;
+	s.depth.store(depth, std::memory_order_release);
+	errno = saved_errno;
+}
+
+}
+
+bool start_sampling(size_t hz) noexcept {
+	if (sampling || hz == 0) return false;
+
+	if (!samples) samples = new Stack_Sample[MAX_STACK_SAMPLE];
+	for (size_t i = 0; i < MAX_STACK_SAMPLE; ++i) samples[i].depth = 0;
+	sample_count = 0;
+	dropped = 0;
+
+	// Never uninstalled, a SIGPROF still pending after stop_sampling would kill the process.
+	if (!handler_installed) {
+		struct sigaction action = {};
+		action.sa_sigaction = on_sigprof;
+		action.sa_flags = SA_SIGINFO | SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		if (sigaction(SIGPROF, &action, nullptr) != 0) return false;
+		handler_installed = true;
+	}
+
+	sampling = true;
+
+	itimerval timer = {};
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = (suseconds_t)std::max<size_t>(1'000'000 / hz, 1);
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+		sampling = false;
+		return false;
+	}
+	return true;
+}
+
+std::optional<size_t> stop_sampling(const std::filesystem::path& folded_path) noexcept {
+	if (!sampling) return std::nullopt;
+
+	itimerval timer = {};
+	setitimer(ITIMER_PROF, &timer, nullptr);
+	sampling = false;
+
+	xstd::unordered_map<size_t, std::string> names;
+	xstd::unordered_map<std::string, size_t> stacks;
+	xstd::vector<std::string> order;
+
+	size_t n = std::min((size_t)sample_count, MAX_STACK_SAMPLE);
+	size_t written = 0;
+	std::string line;
+	for (size_t i = 0; i < n; ++i) {
+		auto& s = samples[i];
+		auto depth = s.depth.load(std::memory_order_acquire);
+		if (depth == 0) continue;
+
+		line = "[";
+		line += s.scope ? s.scope : "no scope";
+		line += "]";
+		for (size_t j = depth; j > 0; --j) {
+			// Return addresses are one past the call, that can already be the next function.
+			auto pc = (size_t)s.pcs[j - 1] - (j > 1 ? 1 : 0);
+			if (!names.contains(pc)) {
+				auto name = get_symbol_name((void*)pc, false);
+				// The format has its own use for those.
+				for (auto& c : name) if (c == ';' || c == '\n') c = '_';
+				names[pc] = std::move(name);
+			}
+			line += ";";
+			line += names[pc];
+		}
+
+		if (!stacks.contains(line)) order.push_back(line);
+		stacks[line]++;
+		written++;
+	}
+
+	FILE* f = fopen(folded_path.generic_string().c_str(), "wb");
+	if (!f) return std::nullopt;
+	defer { fclose(f); };
+
+	for (auto& x : order) fprintf(f, "%s %zu\n", x.c_str(), stacks[x]);
+	if (dropped) fprintf(f, "[dropped] %zu\n", (size_t)dropped);
+	return written;
+}
+
+#else
+
+bool start_sampling(size_t) noexcept { return false; }
+std::optional<size_t> stop_sampling(const std::filesystem::path&) noexcept {
+	return std::nullopt;
+}
+
+#endif
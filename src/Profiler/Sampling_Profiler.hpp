@@ -0,0 +1,19 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+
+// Statistical profiler for the Linux headless build, to see the time spent where no one put a
+// TIMED_BLOCK. SIGPROF fires hz times per second of cpu time, the handler walks the frame
+// pointers of whatever thread it lands on and keeps the return addresses, tagged with the
+// innermost Timed_Block open on that thread.
+// The output is in the folded format of flamegraph.pl and speedscope, one line per stack:
+//   [Timed_Block name];main;Board::update;Board::crowd_update 42
+// Needs -fno-omit-frame-pointer to walk past the first frame and -rdynamic for dladdr to name
+// the functions of the executable. Elsewhere than Linux start_sampling fails and does nothing.
+
+extern bool start_sampling(size_t hz = 1000) noexcept;
+
+// Stops, and writes every stack sampled since start_sampling to folded_path. Returns the number
+// of samples written, nothing if the file can't be written or nothing was sampling.
+extern std::optional<size_t> stop_sampling(const std::filesystem::path& folded_path) noexcept;
@@ -1,76 +1,423 @@
 #include "Tracer.hpp"
 #include <assert.h>
+#include <stdio.h>
+#include <string.h>
 #include "OS/Process.hpp"
 
-size_t frame_sample_log_frame_idx = 0;
-Sample_Log frame_sample_log[];
+std::atomic<size_t> sample_frame = 0;
+
+static std::mutex sample_logs_mutex;
+static xstd::vector<Thread_Sample_Log*> sample_logs;
+
+// Nobody can be reading the log of an exited thread once its last frame left the window.
+static bool reusable(const Thread_Sample_Log& log, size_t current) noexcept {
+	if (log.alive.load(std::memory_order_acquire)) return false;
+	for (auto& x : log.frames) {
+		auto frame = x.frame.load(std::memory_order_relaxed);
+		if (frame != SIZE_MAX && frame + Sample_Log::MAX_FRAME_RECORD >= current) return false;
+	}
+	return true;
+}
+
+Thread_Sample_Log& thread_sample_log() noexcept {
+	// Like the trace rings the logs outlive their thread, the frames they hold are still wanted.
+	struct Owner {
+		Thread_Sample_Log* log = nullptr;
+		~Owner() noexcept { if (log) log->alive.store(false, std::memory_order_release); }
+	};
+	thread_local Owner owner;
+	if (owner.log) return *owner.log;
+
+	std::lock_guard lock(sample_logs_mutex);
+	auto current = current_sample_frame();
+	for (auto& log : sample_logs) if (reusable(*log, current)) {
+		owner.log = log;
+		break;
+	}
+	if (!owner.log) {
+		owner.log = new Thread_Sample_Log;
+		sample_logs.push_back(owner.log);
+	}
+	owner.log->thread_id = get_thread_id();
+	owner.log->alive.store(true, std::memory_order_relaxed);
+	return *owner.log;
+}
+
+void for_each_sample(size_t frame, void (*f)(const Sample&, void*), void* user) noexcept {
+	std::lock_guard lock(sample_logs_mutex);
+	for (auto& log : sample_logs) {
+		auto& x = log->frames[frame % Sample_Log::MAX_FRAME_RECORD];
+		if (x.frame.load(std::memory_order_acquire) != frame) continue;
+
+		size_t n = x.sample_count.load(std::memory_order_acquire);
+		for (size_t i = 0; i < n; ++i) f(x[i], user);
+	}
+}
+
+size_t dropped_samples(size_t frame) noexcept {
+	size_t n = 0;
+	std::lock_guard lock(sample_logs_mutex);
+	for (auto& log : sample_logs) {
+		auto& x = log->frames[frame % Sample_Log::MAX_FRAME_RECORD];
+		if (x.frame.load(std::memory_order_acquire) == frame) n += x.dropped;
+	}
+	return n;
+}
+
+double profiler_ticks_per_second() noexcept {
+#ifdef PROFILER_RDTSC
+	static double frequency = [] {
+		auto t0 = std::chrono::steady_clock::now();
+		auto c0 = profiler_ticks();
+		while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(10));
+		auto t1 = std::chrono::steady_clock::now();
+		auto c1 = profiler_ticks();
+
+		return (c1 - c0) / std::chrono::duration<double>(t1 - t0).count();
+	}();
+	return frequency;
+#else
+	return 1e9;
+#endif
+}
+
+// Layout of a .ltwtrace file:
+//   Trace_File_Header
+//   Trace_Event * n
+//   u32 name count, then for each name u32 length and the bytes
+//   Trace_File_Footer
+struct Trace_File_Header {
+	char magic[8] = { 'L', 'T', 'W', 'T', 'R', 'C', '1', 0 };
+	std::uint64_t pid = 0;
+	double ticks_per_second = 1e9;
+};
+struct Trace_File_Footer {
+	std::uint64_t names_offset = 0;
+	std::uint64_t event_count = 0;
+	std::uint64_t dropped = 0;
+	char magic[8] = { 'L', 'T', 'W', 'T', 'R', 'C', '1', 0 };
+};
+
+static constexpr const char* Trace_Category_Names[] = { "function", "scope", "timer", "session", "counter" };
+static_assert(std::size(Trace_Category_Names) == (size_t)Trace_Category::Count);
+
+struct Open_Timer {
+	std::uint32_t name = 0;
+	Trace_Category cat = Trace_Category::Timer;
+	std::uint64_t start = 0;
+};
+static constexpr size_t Max_Open_Timer = 64;
+thread_local Open_Timer open_timers[Max_Open_Timer];
+thread_local size_t open_timer_count = 0;
 
 Tracer::Tracer() noexcept {}
 
+Trace_Ring& Tracer::thread_ring() noexcept {
+	thread_local Trace_Ring* ring = nullptr;
+	if (ring) return *ring;
+
+	// Rings are never freed, a thread that is gone may still have events to flush.
+	ring = new Trace_Ring;
+	ring->tid = (std::uint32_t)get_thread_id();
+	std::lock_guard lock(rings_mutex);
+	rings.push_back(ring);
+	return *ring;
+}
+
+void Tracer::flush() noexcept {
+	std::lock_guard lock(rings_mutex);
+
+	for (auto& r : rings) {
+		auto h = r->head.load(std::memory_order_acquire);
+		auto t = r->tail.load(std::memory_order_relaxed);
+
+		while (t < h) {
+			auto i = t % Trace_Ring::Capacity;
+			auto n = std::min<std::uint64_t>(h - t, Trace_Ring::Capacity - i);
+			if (file) fwrite(&r->events[i], sizeof(Trace_Event), n, file);
+			events_written += n;
+			t += n;
+		}
+
+		r->tail.store(t, std::memory_order_release);
+	}
+}
+
 void Tracer::begin_session(std::string name) noexcept {
-	assert(!session_running);
+	assert(!recording);
 	current_session_name = name;
-	current_session = dyn_struct::array_t{};
-	session_running = true;
-	timers.push_back(new Scoped_Timer("session", name));
+	current_session_file = std::filesystem::temp_directory_path() / (name + ".ltwtrace");
+	events_written = 0;
+
+	file = fopen(current_session_file.generic_string().c_str(), "wb");
+	if (!file) {
+		auto path = current_session_file.generic_string();
+		printf("Can't open %s, the trace won't be saved\n", path.c_str());
+	} else {
+		Trace_File_Header header;
+		header.pid = get_process_id();
+		header.ticks_per_second = profiler_ticks_per_second();
+		fwrite(&header, sizeof(header), 1, file);
+	}
+
+	{
+		// Whatever was left from outside of a session is not part of this one.
+		std::lock_guard lock(rings_mutex);
+		for (auto& r : rings) r->tail.store(r->head.load());
+		for (auto& r : rings) r->dropped = 0;
+	}
+
+	recording = true;
+	begin(intern(name), Trace_Category::Session);
+
+#ifndef __EMSCRIPTEN__
+	flusher_running = true;
+	flusher = std::thread([&] {
+		while (flusher_running) {
+			flush();
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	});
+#endif
 }
 
 void Tracer::end_session(std::filesystem::path path) noexcept {
-	assert(session_running);
+	assert(recording);
+
+	while (open_timer_count > 0) end();
+	recording = false;
 
-	for (uint32_t i = timers.size() - 1; i + 1 > 0; --i) {
-		delete timers[i];
+#ifndef __EMSCRIPTEN__
+	flusher_running = false;
+	if (flusher.joinable()) flusher.join();
+#endif
+	flush();
+
+	std::uint64_t dropped = 0;
+	{
+		std::lock_guard lock(rings_mutex);
+		for (auto& r : rings) dropped += r->dropped;
 	}
-	timers.clear();
 
-	dyn_struct obj = dyn_struct::structure_t{};
-	obj["traceEvents"] = std::move(current_session);
-	auto save_path = path / (current_session_name + ".json");
-	save_to_json_file(obj, save_path);
-	printf("Wrote session to %s\n", save_path.generic_string().c_str());
+	if (!file) return;
 
-	session_running = false;
-}
+	Trace_File_Footer footer;
+	footer.names_offset = (std::uint64_t)ftell(file);
+	footer.event_count = events_written;
+	footer.dropped = dropped;
 
-void Tracer::push(dyn_struct str) noexcept {
-	assert(session_running);
+	std::uint32_t n = xstd::interned_count();
+	fwrite(&n, sizeof(n), 1, file);
+	for (std::uint32_t i = 0; i < n; ++i) {
+		auto x = xstd::Interned{ i }.view();
+		std::uint32_t len = (std::uint32_t)x.size();
+		fwrite(&len, sizeof(len), 1, file);
+		fwrite(x.data(), 1, len, file);
+	}
+	fwrite(&footer, sizeof(footer), 1, file);
+	fclose(file);
+	file = nullptr;
 
-	current_session.push_back(std::move(str));
+	std::error_code ec;
+	std::filesystem::create_directories(path, ec);
+	auto save_path = path / (current_session_name + ".ltwtrace");
+	std::filesystem::copy_file(
+		current_session_file, save_path, std::filesystem::copy_options::overwrite_existing, ec
+	);
+	if (ec) {
+		printf("Can't write the session to %s\n", save_path.generic_string().c_str());
+		return;
+	}
+	std::filesystem::remove(current_session_file, ec);
+
+	printf(
+		"Wrote session to %s, %llu events, %llu dropped\n",
+		save_path.generic_string().c_str(),
+		(unsigned long long)events_written,
+		(unsigned long long)dropped
+	);
 }
 
-void Tracer::begin(std::string name) noexcept {
-	timers.push_back(new Scoped_Timer("timer", name));
+void Tracer::begin(std::uint32_t name, Trace_Category cat) noexcept {
+	if (open_timer_count >= Max_Open_Timer) return;
+	open_timers[open_timer_count++] = { name, cat, trace_now() };
 }
 
 void Tracer::end() noexcept {
-	delete timers.back();
-	timers.pop_back();
+	if (open_timer_count == 0) return;
+	auto& t = open_timers[--open_timer_count];
+	record(t.cat, t.name, t.start, trace_now());
 }
 
-Scoped_Timer::Scoped_Timer(std::string cat, std::string name) noexcept {
-	this->cat = cat;
-	this->name = name;
-	this->ph = Phase::X;
-	pid = get_process_id();
-	tid = get_thread_id();
-	ts = std::chrono::steady_clock::now();
+static void write_json_string(FILE* f, std::string_view s) noexcept {
+	fputc('"', f);
+	for (auto c : s) {
+		if (c == '"' || c == '\\') fputc('\\', f);
+		if ((unsigned char)c < 0x20) { fprintf(f, "\\u%04x", c); continue; }
+		fputc(c, f);
+	}
+	fputc('"', f);
 }
 
-Scoped_Timer::~Scoped_Timer() noexcept {
-	auto end = std::chrono::steady_clock::now();
-	auto dur = std::chrono::duration_cast<std::chrono::microseconds>(end - ts).count();
-
-	dyn_struct str = dyn_struct::structure_t{};
-	str["cat"] = cat;
-	str["name"] = name;
-	str["dur"] = dur;
-	str["ph"] = *ph;
-	str["pid"] = pid;
-	str["tid"] = tid;
-	str["ts"] = ts.time_since_epoch().count() / 1000;
-	str["ph"] = ph;
-
-	Tracer::get().push(std::move(str));
+bool convert_trace_to_chrome_json(
+	const std::filesystem::path& from, const std::filesystem::path& to
+) noexcept {
+	FILE* in = fopen(from.generic_string().c_str(), "rb");
+	if (!in) return false;
+	defer { fclose(in); };
+
+	Trace_File_Header header;
+	Trace_File_Footer footer;
+	if (fread(&header, sizeof(header), 1, in) != 1) return false;
+	if (memcmp(header.magic, Trace_File_Header{}.magic, sizeof(header.magic)) != 0) return false;
+	if (fseek(in, -(long)sizeof(footer), SEEK_END) != 0) return false;
+	if (fread(&footer, sizeof(footer), 1, in) != 1) return false;
+
+	std::vector<std::string> names;
+	fseek(in, (long)footer.names_offset, SEEK_SET);
+	std::uint32_t n = 0;
+	if (fread(&n, sizeof(n), 1, in) != 1) return false;
+	for (std::uint32_t i = 0; i < n; ++i) {
+		std::uint32_t len = 0;
+		if (fread(&len, sizeof(len), 1, in) != 1) return false;
+		std::string x(len, '\0');
+		if (fread(x.data(), 1, len, in) != len) return false;
+		names.push_back(std::move(x));
+	}
+
+	FILE* out = fopen(to.generic_string().c_str(), "wb");
+	if (!out) return false;
+	defer { fclose(out); };
+
+	// Chrome wants microseconds, relative to the first event keeps them readable.
+	double us_per_tick = 1e6 / header.ticks_per_second;
+	fseek(in, sizeof(header), SEEK_SET);
+	std::uint64_t origin = UINT64_MAX;
+	for (std::uint64_t i = 0; i < footer.event_count; ++i) {
+		Trace_Event e;
+		if (fread(&e, sizeof(e), 1, in) != 1) break;
+		origin = std::min(origin, e.start);
+	}
+
+	auto category_name = [] (Trace_Category c) {
+		return (size_t)c < std::size(Trace_Category_Names) ? Trace_Category_Names[(size_t)c] : "?";
+	};
+
+	fprintf(out, "{\"traceEvents\":[\n");
+	fseek(in, sizeof(header), SEEK_SET);
+	for (std::uint64_t i = 0; i < footer.event_count; ++i) {
+		Trace_Event e;
+		if (fread(&e, sizeof(e), 1, in) != 1) break;
+
+		fprintf(out, "%s{\"name\":", i ? ",\n" : "");
+		write_json_string(out, e.name < names.size() ? names[e.name] : "?");
+
+		// Counters keep their value where the end of a scope would be.
+		if (e.cat == Trace_Category::Counter) {
+			fprintf(
+				out,
+				",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%llu,\"tid\":%u,\"args\":{\"value\":%lld}}",
+				(e.start - origin) * us_per_tick,
+				(unsigned long long)header.pid,
+				e.tid,
+				(long long)(std::int64_t)e.end
+			);
+			continue;
+		}
+
+		fprintf(
+			out,
+			",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%llu,\"tid\":%u}",
+			category_name(e.cat),
+			(e.start - origin) * us_per_tick,
+			(e.end - e.start) * us_per_tick,
+			(unsigned long long)header.pid,
+			e.tid
+		);
+	}
+	fprintf(out, "\n],\"otherData\":{\"dropped\":%llu}}\n", (unsigned long long)footer.dropped);
+
+	return true;
 }
 
+bool write_frames_to_chrome_json(
+	size_t first, size_t last, const std::filesystem::path& to, size_t mark
+) noexcept {
+	struct Frame {
+		size_t frame = 0;
+		std::uint64_t start = UINT64_MAX;
+		std::uint64_t end = 0;
+	};
+	std::vector<Frame> frames;
+	std::uint64_t origin = UINT64_MAX;
+	for (size_t i = first; i <= last; ++i) {
+		Frame f = { .frame = i };
+		for_each_sample(i, [&] (const Sample& x) {
+			f.start = std::min(f.start, x.time_start);
+			f.end = std::max(f.end, x.time_end);
+		});
+		if (f.start == UINT64_MAX) continue;
+		origin = std::min(origin, f.start);
+		frames.push_back(f);
+	}
+
+	FILE* out = fopen(to.generic_string().c_str(), "wb");
+	if (!out) return false;
+	defer { fclose(out); };
+
+	double us_per_tick = 1e6 / profiler_ticks_per_second();
+	auto pid = (unsigned long long)get_process_id();
+	bool first_event = true;
+	auto next_event = [&] {
+		fprintf(out, "%s", first_event ? "" : ",\n");
+		first_event = false;
+	};
+
+	fprintf(out, "{\"traceEvents\":[\n");
+	for (auto& f : frames) {
+		if (f.frame == mark) {
+			next_event();
+			fprintf(
+				out,
+				"{\"name\":\"over budget\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":%llu,\"tid\":0}",
+				(f.start - origin) * us_per_tick,
+				pid
+			);
+		}
+
+		for_each_sample(f.frame, [&] (const Sample& x) {
+			next_event();
+			fprintf(out, "{\"name\":");
+			write_json_string(out, x.function_name);
+			fprintf(
+				out,
+				",\"cat\":\"frame %zu\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%llu,\"tid\":%zu}",
+				f.frame,
+				(x.time_start - origin) * us_per_tick,
+				(x.time_end - x.time_start) * us_per_tick,
+				pid,
+				x.thread_id
+			);
+		});
 
+		// Counters are taken when the frame closes.
+		for (size_t i = 0; i < counter_registry.count; ++i) {
+			auto v = counter_value(f.frame, i);
+			if (!v) continue;
+
+			next_event();
+			fprintf(out, "{\"name\":");
+			write_json_string(out, counter_registry.names[i]);
+			fprintf(
+				out,
+				",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%llu,\"tid\":0,\"args\":{\"value\":%lld}}",
+				(f.end - origin) * us_per_tick,
+				pid,
+				(long long)*v
+			);
+		}
+	}
+	fprintf(out, "\n]}\n");
+
+	return true;
+}
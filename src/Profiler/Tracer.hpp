@@ -3,56 +3,141 @@
 #include <filesystem>
 #include <string>
 #include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <dyn_struct.hpp>
 #include <chrono>
 
 #include "OS/Process.hpp"
+#include "Profiler/Clock.hpp"
+#include "Profiler/Counters.hpp"
+#include "xstd.hpp"
 #include "std/vector.hpp"
+#include "std/unordered_map.hpp"
 
-struct Scoped_Timer {
+// Trace events are fixed size binary records pushed in a ring owned by the thread that emits
+// them, a background thread drains every ring to a file while a session is running. The file
+// is turned into a Chrome trace (chrome://tracing, perfetto) offline by
+// convert_trace_to_chrome_json, `LTW_headless --convert-trace in.ltwtrace out.json`.
+
+enum class Trace_Category : std::uint32_t {
+	Function = 0,
+	Scope,
+	Timer,
+	Session,
+	Counter,
+	Count
+};
+
+struct Trace_Event {
+	std::uint64_t start = 0;
+	std::uint64_t end   = 0;
+	std::uint32_t name  = 0;
+	Trace_Category cat  = Trace_Category::Scope;
+	std::uint32_t tid   = 0;
+	std::uint32_t pad   = 0;
+};
+static_assert(sizeof(Trace_Event) == 32);
+
+// Single producer (the owning thread), single consumer (the flusher). When the flusher falls
+// behind the newest events are dropped, and counted, rather than blocking the producer.
+struct Trace_Ring {
+	static constexpr size_t Capacity = 1 << 16;
 
-	std::string cat;
-	std::string name;
-	std::size_t pid;
-	std::size_t tid;
-	std::chrono::time_point<std::chrono::steady_clock> ts;
-	struct Phase {
-		static constexpr auto B = "B";
-		static constexpr auto E = "E";
-		static constexpr auto I = "I";
-		static constexpr auto S = "S";
-		static constexpr auto F = "F";
-		static constexpr auto X = "X";
-		static constexpr auto Args = "Args";
-	};
-	const char* ph;
-
-	Scoped_Timer(std::string cat, std::string name) noexcept;
-	~Scoped_Timer() noexcept;
+	std::array<Trace_Event, Capacity> events;
+	std::atomic<std::uint64_t> head = 0;
+	std::atomic<std::uint64_t> tail = 0;
+	std::atomic<std::uint64_t> dropped = 0;
+
+	// Of the owning thread, asked once when the ring is made: it's a syscall on Linux.
+	std::uint32_t tid = 0;
+
+	bool push(const Trace_Event& e) noexcept {
+		auto h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) >= Capacity) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		events[h % Capacity] = e;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
 };
 
+inline std::uint64_t trace_now() noexcept { return profiler_ticks(); }
+
 struct Tracer {
 private:
 	Tracer() noexcept;
 
-	dyn_struct current_session;
 	std::string current_session_name;
-	bool session_running = false;
-	xstd::vector<Scoped_Timer*> timers;
+	std::filesystem::path current_session_file;
+	FILE* file = nullptr;
+	std::uint64_t events_written = 0;
+	std::atomic<bool> recording = false;
+
+	std::mutex rings_mutex;
+	xstd::vector<Trace_Ring*> rings;
+
+	std::thread flusher;
+	std::atomic<bool> flusher_running = false;
+
+	Trace_Ring& thread_ring() noexcept;
+	void flush() noexcept;
 
 public:
 	static Tracer& get() noexcept { static Tracer t; return t; };
 
+	// Names are interned once per call site, events only carry the id. It's the id of
+	// xstd::intern, the whole table goes in the file when a session ends.
+	static std::uint32_t intern(std::string_view name) noexcept {
+		return xstd::intern(name).id;
+	}
+
 	void begin_session(std::string name) noexcept;
 	void end_session(std::filesystem::path path) noexcept;
 
-	void push(dyn_struct str) noexcept;
+	void record(
+		Trace_Category cat, std::uint32_t name, std::uint64_t start, std::uint64_t end
+	) noexcept {
+		if (!recording.load(std::memory_order_relaxed)) return;
+
+		auto& ring = thread_ring();
+
+		Trace_Event e;
+		e.start = start;
+		e.end   = end;
+		e.name  = name;
+		e.cat   = cat;
+		e.tid   = ring.tid;
+		ring.push(e);
+#ifdef __EMSCRIPTEN__
+		// No flusher thread there, the producer drains its own ring.
+		if (ring.head - ring.tail > Trace_Ring::Capacity / 2) flush();
+#endif
+	}
 
-	void begin(std::string name) noexcept;
+	void begin(std::uint32_t name, Trace_Category cat = Trace_Category::Timer) noexcept;
 	void end() noexcept;
 };
 
+extern bool convert_trace_to_chrome_json(
+	const std::filesystem::path& from, const std::filesystem::path& to
+) noexcept;
+
+struct Scoped_Timer {
+	std::uint32_t name;
+	Trace_Category cat;
+	std::uint64_t start;
+
+	Scoped_Timer(Trace_Category cat, std::uint32_t name) noexcept :
+		name(name), cat(cat), start(trace_now()) {}
+	~Scoped_Timer() noexcept { Tracer::get().record(cat, name, start, trace_now()); }
+};
+
 struct Scoped_Session {
 	std::filesystem::path path;
 
@@ -65,20 +150,28 @@ struct Scoped_Session {
 	}
 };
 
+// The id of a string literal, interned the first time this line runs.
+#define TRACE_NAME(n) ([] { static const std::uint32_t id = Tracer::intern(n); return id; }())
 
 #ifdef _MSC_VER
     #define __PRETTY_FUNCTION__ __FUNCSIG__
 #endif
 #ifdef PROFILER
-#define PROFILER_SCOPE_SESSION(n, p) Scoped_Session scoped_session##__COUNTER__ (n, p);
+#define PROFILER_SCOPE_SESSION(n, p) Scoped_Session CONCAT(scoped_session_, __COUNTER__) (n, p);
 #define PROFILER_SESSION_BEGIN(n) Tracer::get().begin_session(n);
 #define PROFILER_SESSION_END(n) Tracer::get().end_session(n);
-#define PROFILER_FUNCTION() Scoped_Timer scoped_timer##__COUNTER__ ("function", __PRETTY_FUNCTION__);
-#define PROFILER_SCOPE(n) Scoped_Timer scoped_timer##__COUNTER__ ("scope", n);
-#define PROFILER_BEGIN(n) Tracer::get().begin(n);
+#define PROFILER_FUNCTION()\
+	static const std::uint32_t CONCAT(trace_function_, __LINE__) =\
+		Tracer::intern(__PRETTY_FUNCTION__);\
+	Scoped_Timer CONCAT(scoped_timer_, __LINE__) (\
+		Trace_Category::Function, CONCAT(trace_function_, __LINE__)\
+	);
+#define PROFILER_SCOPE(n)\
+	Scoped_Timer CONCAT(scoped_timer_, __COUNTER__) (Trace_Category::Scope, TRACE_NAME(n));
+#define PROFILER_BEGIN(n) Tracer::get().begin(TRACE_NAME(n));
 #define PROFILER_END() Tracer::get().end();
-#define PROFILER_BEGIN_SEQ(n) Tracer::get().begin(n);
-#define PROFILER_SEQ(n) Tracer::get().end(); Tracer::get().begin(n);
+#define PROFILER_BEGIN_SEQ(n) Tracer::get().begin(TRACE_NAME(n));
+#define PROFILER_SEQ(n) Tracer::get().end(); Tracer::get().begin(TRACE_NAME(n));
 #define PROFILER_END_SEQ() Tracer::get().end();
 #else
 #define PROFILER_SCOPE_SESSION(x, y)
@@ -93,38 +186,133 @@ struct Scoped_Session {
 #define PROFILER_END_SEQ()
 #endif
 
+// Frame sampler behind TIMED_FUNCTION and TIMED_BLOCK. Every thread writes its samples in its
+// own log, one slot per frame for the last MAX_FRAME_RECORD frames, so there is no contention
+// and no torn slot. A full slot drops the sample and counts it.
+// The samples live in chunks allocated the first time a slot needs them and kept when it's
+// recycled, so a log only weighs what its busiest frames needed, up to MAX_THREAD_SAMPLE. The
+// log of a thread that exited is handed to the next thread once its frames are out of the
+// window.
+
 struct Sample {
 	const char* function_name = nullptr;
 	size_t thread_id   = 0;
-	std::uint64_t time_start = 0;
+	std::uint64_t time_start = 0; // profiler ticks
 	std::uint64_t time_end   = 0;
 };
 
 struct Sample_Log {
 	static constexpr size_t MAX_FRAME_RECORD = 200;
 	static constexpr size_t MAX_SAMPLE = 4096;
-	std::array<Sample, MAX_SAMPLE> samples;
+	static constexpr size_t CHUNK_SAMPLE = 128;
+	static constexpr size_t MAX_CHUNK = MAX_SAMPLE / CHUNK_SAMPLE;
+
+	// Chunks are never freed nor moved, a reader late on a recycled slot reads garbage at worst.
+	std::atomic<Sample*> chunks[MAX_CHUNK] = {};
+	// Only the owning thread writes those, others may read them for frames that are done.
 	std::atomic<size_t> sample_count = 0;
+	std::atomic<size_t> dropped = 0;
+	std::atomic<size_t> frame = SIZE_MAX;
+
+	const Sample& operator[](size_t i) const noexcept {
+		return chunks[i / CHUNK_SAMPLE].load(std::memory_order_acquire)[i % CHUNK_SAMPLE];
+	}
+};
+
+struct Thread_Sample_Log {
+	// 8 MB of samples, a frame of the main thread is far from 4096 samples.
+	static constexpr size_t MAX_THREAD_SAMPLE = 1 << 18;
+
+	size_t thread_id = 0;
+	size_t allocated = 0; // samples in chunks, only touched by the owner.
+	std::atomic<bool> alive = true;
+	Sample_Log frames[Sample_Log::MAX_FRAME_RECORD];
+
+	// Makes room for sample n of f, false if the thread is out of its budget.
+	bool reserve(Sample_Log& f, size_t n) noexcept {
+		if (n % Sample_Log::CHUNK_SAMPLE) return true;
+		auto& c = f.chunks[n / Sample_Log::CHUNK_SAMPLE];
+		if (c.load(std::memory_order_relaxed)) return true;
+		if (allocated + Sample_Log::CHUNK_SAMPLE > MAX_THREAD_SAMPLE) return false;
+
+		allocated += Sample_Log::CHUNK_SAMPLE;
+		c.store(new Sample[Sample_Log::CHUNK_SAMPLE], std::memory_order_release);
+		return true;
+	}
 };
-extern size_t frame_sample_log_frame_idx;
-extern Sample_Log frame_sample_log[Sample_Log::MAX_FRAME_RECORD];
+
+// Frame number the samples are currently recorded for, only ever grows.
+extern std::atomic<size_t> sample_frame;
+
+extern Thread_Sample_Log& thread_sample_log() noexcept;
+
+// Closes the current frame for every thread.
+inline void next_sample_frame() noexcept {
+	snapshot_counters(sample_frame.load(std::memory_order_relaxed));
+	sample_frame.fetch_add(1, std::memory_order_release);
+}
+inline size_t current_sample_frame() noexcept {
+	return sample_frame.load(std::memory_order_acquire);
+}
+
+inline void record_sample(
+	const char* function_name, std::uint64_t start, std::uint64_t end
+) noexcept {
+	auto& log = thread_sample_log();
+	auto frame = sample_frame.load(std::memory_order_relaxed);
+	auto& f = log.frames[frame % Sample_Log::MAX_FRAME_RECORD];
+
+	if (f.frame.load(std::memory_order_relaxed) != frame) {
+		f.sample_count.store(0, std::memory_order_relaxed);
+		f.dropped.store(0, std::memory_order_relaxed);
+		f.frame.store(frame, std::memory_order_release);
+	}
+
+	auto n = f.sample_count.load(std::memory_order_relaxed);
+	if (n >= Sample_Log::MAX_SAMPLE || !log.reserve(f, n)) {
+		f.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	auto chunk = f.chunks[n / Sample_Log::CHUNK_SAMPLE].load(std::memory_order_relaxed);
+	chunk[n % Sample_Log::CHUNK_SAMPLE] = { function_name, log.thread_id, start, end };
+	f.sample_count.store(n + 1, std::memory_order_release);
+}
+
+// Every sample recorded during frame, on any thread. Only meaningful for frames that are done
+// and not yet recycled: current_sample_frame() - MAX_FRAME_RECORD < frame < current.
+extern void for_each_sample(size_t frame, void (*f)(const Sample&, void*), void* user) noexcept;
+template<typename F>
+void for_each_sample(size_t frame, F&& f) noexcept {
+	for_each_sample(frame, [] (const Sample& s, void* user) { (*(F*)user)(s); }, &f);
+}
+extern size_t dropped_samples(size_t frame) noexcept;
+
+// Chrome trace of the TIMED_BLOCK samples and the counters of the frames first to last, those
+// still in the logs. mark, if it's one of them, gets an instant event at its start.
+extern bool write_frames_to_chrome_json(
+	size_t first, size_t last, const std::filesystem::path& to, size_t mark = SIZE_MAX
+) noexcept;
+
+// Innermost Timed_Block alive on this thread, nullptr outside of any.
+inline thread_local const char* current_timed_block = nullptr;
 
 struct Timed_Block {
-	Sample s;
+	const char* function_name;
+	const char* parent;
+	std::uint64_t start;
 
-	Timed_Block(const char* function_name) noexcept {
-		s.function_name = function_name;
-		s.time_start = xstd::nanoseconds();
-		s.thread_id = get_thread_id();
+	Timed_Block(const char* function_name) noexcept :
+		function_name(function_name), parent(current_timed_block), start(profiler_ticks())
+	{
+		current_timed_block = function_name;
 	}
 
 	~Timed_Block() noexcept {
-		s.time_end = xstd::nanoseconds();
-
-		auto& f = frame_sample_log[frame_sample_log_frame_idx];
-		f.samples[f.sample_count++] = s;
+		record_sample(function_name, start, profiler_ticks());
+		current_timed_block = parent;
 	}
 };
 
-#define TIMED_FUNCTION Timed_Block scoped_timed_bloc_##__COUNTER__(__PRETTY_FUNCTION__);
-#define TIMED_BLOCK(name) Timed_Block scoped_timed_bloc_##__COUNTER__(name);
\ No newline at end of file
+#define TIMED_FUNCTION Timed_Block CONCAT(scoped_timed_bloc_, __COUNTER__)(__PRETTY_FUNCTION__);
+#define TIMED_BLOCK(name) Timed_Block CONCAT(scoped_timed_bloc_, __COUNTER__)(name);
@@ -10,13 +10,9 @@
 #include "Effect.hpp"
 
 struct Tower_Base {
-	union {
-		Rectangleu tile_rec;
-		struct {
-			Vector2u tile_pos;
-			Vector2u tile_size = {1, 1};
-		};
-	};
+	Vector2u tile_pos;
+	Vector2u tile_size = {1, 1};
+	Rectangleu tile_rec() const noexcept { return { tile_pos, tile_size }; }
 
 	size_t object_id = 0;
 	size_t gold_cost = 5;
@@ -169,4 +165,5 @@ struct Tower {
 
 	Kind get_upgrade() noexcept;
 };
+XSTD_TRIVIALLY_RELOCATABLE(Tower);
 
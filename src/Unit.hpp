@@ -8,6 +8,15 @@
 #include "Player.hpp"
 
 struct Unit_Base {
+	// What is the same for every unit of a kind, the kinds hide the ones they change. Read
+	// through unit_info(kind), not from a unit.
+	static constexpr float      Base_Speed  = 2.f;
+	static constexpr float      Base_Health = 1.f;
+	static constexpr size_t     Cost        = 5;
+	static constexpr size_t     Income      = 1;
+	static constexpr size_t     Batch       = 5;
+	static constexpr Ressources Drop        = {};
+
 	size_t object_id = 0;
 
 	float life_time = 0;
@@ -16,82 +25,80 @@ struct Unit_Base {
 	size_t target_tile  = SIZE_MAX;
 	Vector2f pos;
 	Vector2f last_pos;
-	float speed = 2.f;
-
-	float health = 1.f;
+	float speed = Base_Speed;
 
-	size_t income = 1;
-	size_t cost   = 5;
-	size_t batch  = 5;
+	float health = Base_Health;
 
 	Vector3f color = {1, 1, 1};
 
 	bool to_die = false;
 	float invincible = 0.f;
 
-	virtual void hit(float damage) noexcept;
-
-	virtual Ressources get_drop() noexcept { return {}; }
+	void hit(float damage) noexcept;
 };
 
 struct Methane : Unit_Base {
+	static constexpr Ressources Drop = {.gold = 1, .carbons = 1, .hydrogens = 4};
+
 	Methane() noexcept {
-		speed = 2.f;
 		object_id = asset::Object_Id::Methane;
 	}
-
-	virtual Ressources get_drop() noexcept { return {.gold = 1, .carbons = 1, .hydrogens = 4}; }
 };
 struct Ethane : Unit_Base {
 	using split_to = Methane;
-	size_t     split_n  = 2;
+	static constexpr size_t     split_n    = 2;
+	static constexpr float      Base_Speed = 1.5f;
+	static constexpr Ressources Drop       = {.gold = 1, .carbons = 2, .hydrogens = 6};
 
 	Ethane() noexcept {
-		speed = 1.5f;
+		speed = Base_Speed;
 		object_id = asset::Object_Id::Ethane;
 		color /= 2;
 	}
-	virtual Ressources get_drop() noexcept { return {.gold = 1, .carbons = 2, .hydrogens = 6}; }
 };
 struct Propane : Unit_Base {
 	using split_to = Ethane;
-	size_t     split_n  = 2;
+	static constexpr size_t     split_n    = 2;
+	static constexpr float      Base_Speed = 0.75f;
+	static constexpr Ressources Drop       = {.gold = 1, .carbons = 3, .hydrogens = 8};
 
 	Propane() noexcept {
-		speed = 0.75f;
+		speed = Base_Speed;
 		object_id = asset::Object_Id::Propane;
 		color /= 3;
 	}
-	virtual Ressources get_drop() noexcept { return {.gold = 1, .carbons = 3, .hydrogens = 8}; }
 };
 struct Butane : Unit_Base {
 	using split_to = Propane;
-	size_t     split_n  = 2;
+	static constexpr size_t     split_n    = 2;
+	static constexpr float      Base_Speed = 0.25f;
+	static constexpr Ressources Drop       = {.gold = 1, .carbons = 4, .hydrogens = 10};
 
 	Butane() noexcept {
-		speed = 0.25f;
+		speed = Base_Speed;
 		object_id = asset::Object_Id::Butane;
 		color /= 5;
 	}
-	virtual Ressources get_drop() noexcept { return {.gold = 1, .carbons = 4, .hydrogens = 10}; }
 };
 struct Water   : Unit_Base {
+	static constexpr Ressources Drop = {.gold = 1, .hydrogens = 2, .oxygens = 1};
+
 	Water()   noexcept {
 		object_id = asset::Object_Id::Water;
-		speed = 2;
 	}
-
-	virtual Ressources get_drop() noexcept { return {.gold = 1, .hydrogens = 2, .oxygens = 1}; }
 };
 struct Oxygen  : Unit_Base {
+	static constexpr float      Base_Speed = 1.f;
+	static constexpr Ressources Drop       = {.gold = 1, .oxygens = 2};
+
 	Oxygen() noexcept {
 		object_id = asset::Object_Id::Oxygen;
-		health = 1.f;
-		speed  = 1.f;
+		speed  = Base_Speed;
 	}
-	virtual Ressources get_drop() noexcept { return {.gold = 1, .oxygens = 2}; }
 };
 struct Chloroform  : Unit_Base {
+	static constexpr float      Base_Speed = 0.75f;
+	static constexpr Ressources Drop       = {.gold = 1, .carbons = 1, .hydrogens = 2};
 
 	float debuff_range = 1.f;
 	float debuff_cd = 1.f;
@@ -99,10 +106,8 @@ struct Chloroform  : Unit_Base {
 
 	Chloroform() noexcept {
 		object_id = asset::Object_Id::Chloroform;
-		health = 1.f;
-		speed  = 0.75f;
+		speed  = Base_Speed;
 	}
-	virtual Ressources get_drop() noexcept { return {.gold = 1, .carbons = 1, .hydrogens = 2}; }
 };
 
 template<typename T> struct Merge {};
@@ -111,8 +116,6 @@ template<>           struct Merge<Methane> { using type = Ethane; };
 template<>           struct Merge<Ethane>  { using type = Propane; };
 template<>           struct Merge<Propane> { using type = Butane; };
 
-#define UNIT_MERGE Methane, Ethane, Propane
-#define UNIT_SPLIT Ethane, Propane, Butane
 #define UNIT_DIE_CATALYST_MERGE Water
 #define UNIT_DIE_INVINCIBLE_BUFF Oxygen
 #define LIST_UNIT(X) X(Methane) X(Ethane) X(Propane) X(Butane) X(Water) X(Oxygen) X(Chloroform)
@@ -124,3 +127,60 @@ struct Unit {
 	size_t id = 0;
 	bool to_remove = false;
 };
+XSTD_TRIVIALLY_RELOCATABLE(Unit);
+
+// The constants of a kind, one per Unit::Kind made at compile time from LIST_UNIT. Dying,
+// splitting and merging go through there and the kind instead of virtual calls.
+struct Unit_Info {
+	Ressources drop;
+	float      speed  = 0;
+	float      health = 0;
+	size_t     cost   = 0;
+	size_t     income = 0;
+	size_t     batch  = 0;
+
+	// None_Kind when it doesn't split or doesn't merge.
+	Unit::Kind split_to = Unit::None_Kind;
+	size_t     split_n  = 0;
+	Unit::Kind merge_to = Unit::None_Kind;
+};
+
+template<typename, typename = void>
+struct unit_splits : std::false_type {};
+template<typename T>
+struct unit_splits<T, std::void_t<typename T::split_to>> : std::true_type {};
+
+template<typename, typename = void>
+struct unit_merges : std::false_type {};
+template<typename T>
+struct unit_merges<T, std::void_t<Merge_t<T>>> : std::true_type {};
+
+template<typename T>
+constexpr Unit_Info unit_info_of() noexcept {
+	Unit_Info info;
+	info.drop   = T::Drop;
+	info.speed  = T::Base_Speed;
+	info.health = T::Base_Health;
+	info.cost   = T::Cost;
+	info.income = T::Income;
+	info.batch  = T::Batch;
+	if constexpr (unit_splits<T>::value) {
+		info.split_to = Unit::MAP_type_kind<typename T::split_to>::kind;
+		info.split_n  = T::split_n;
+	}
+	if constexpr (unit_merges<T>::value) info.merge_to = Unit::MAP_type_kind<Merge_t<T>>::kind;
+	return info;
+}
+
+#define unit_info_X(x) , unit_info_of<x>()
+inline constexpr Unit_Info Unit_Infos[Unit::Count] = { Unit_Info{} LIST_UNIT(unit_info_X) };
+#undef unit_info_X
+
+constexpr const Unit_Info& unit_info(Unit::Kind kind) noexcept {
+	return Unit_Infos[kind];
+}
+
+// No vtable left, copying or moving a Unit is the memcpy of sum_type and nothing else.
+#define unit_trivial_X(x) static_assert(std::is_trivially_copyable_v<x>);
+LIST_UNIT(unit_trivial_X)
+#undef unit_trivial_X
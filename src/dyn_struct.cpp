@@ -2,120 +2,259 @@
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include "dyn_struct.hpp"
 
+#include <bit>
 #include <cassert>
 #include <functional>
+#include <math.h>
 
 #include "OS/file.hpp"
 #include "std/vector.hpp"
 
-namespace xstd {
-	template<>
-	struct hash<std::string> {
-		unsigned long long operator()(const std::string& x) noexcept {
-			return std::hash<std::string>()(x);
+using Kind = dyn_struct::Kind;
+
+struct dyn_struct::String : dyn_struct::Shared {
+	std::string string;
+
+	Shared* clone() const noexcept override { return new String(*this); }
+};
+
+struct dyn_struct::Children : dyn_struct::Shared {
+	static constexpr size_t First = 4;
+
+	// Structures have keys, arrays don't.
+	bool keyed = false;
+	size_t size = 0;
+	dyn_struct first[First];
+	xstd::Interned first_keys[First];
+	// Segment k holds First << k children, segment 0 is the inline one. Keys are only there
+	// for structures.
+	xstd::vector<dyn_struct*> segments;
+	xstd::vector<xstd::Interned*> key_segments;
+
+	Children(bool keyed) noexcept : keyed(keyed) {}
+	// Only this level is copied, the children are shared in turn.
+	Children(const Children& other) noexcept : Shared(other), keyed(other.keyed) {
+		for (size_t i = 0; i < other.size; ++i) {
+			append() = const_cast<Children&>(other).at(i);
+			if (keyed) key_at(i) = const_cast<Children&>(other).key_at(i);
 		}
-	};
+	}
+	~Children() noexcept {
+		for (auto x : segments) delete[] x;
+		for (auto x : key_segments) delete[] x;
+	}
+
+	Shared* clone() const noexcept override { return new Children(*this); }
+
+	static size_t segment_of(size_t i) noexcept { return std::bit_width(i / First + 1) - 1; }
+	static size_t segment_start(size_t k) noexcept { return First * (((size_t)1 << k) - 1); }
+
+	dyn_struct& at(size_t i) noexcept {
+		if (i < First) return first[i];
+		auto k = segment_of(i);
+		return segments[k - 1][i - segment_start(k)];
+	}
+	xstd::Interned& key_at(size_t i) noexcept {
+		if (i < First) return first_keys[i];
+		auto k = segment_of(i);
+		return key_segments[k - 1][i - segment_start(k)];
+	}
+
+	dyn_struct& append() noexcept {
+		auto i = size++;
+		if (i >= First && segment_of(i) > segments.size()) {
+			auto n = First << segment_of(i);
+			segments.push_back(new dyn_struct[n]);
+			if (keyed) key_segments.push_back(new xstd::Interned[n]);
+		}
+		return at(i);
+	}
+
+	// Keys are compared as u32 one after the other, objects are small.
+	size_t index_of(xstd::Interned k) const noexcept {
+		for (size_t i = 0; i < size && i < First; ++i) if (first_keys[i] == k) return i;
+		for (size_t s = 0; s < key_segments.size(); ++s) {
+			auto start = segment_start(s + 1);
+			auto n = std::min(size - start, First << (s + 1));
+			for (size_t i = 0; i < n; ++i) if (key_segments[s][i] == k) return start + i;
+		}
+		return SIZE_MAX;
+	}
+};
+
+dyn_struct::Value::Value(Kind kind, Shared* p) noexcept : kind(kind) {
+	if (has_shared()) new (&shared) Cow_Ptr<Shared>(p);
+	else              integer = 0;
+}
+dyn_struct::Value::Value(const Value& other) noexcept : kind(other.kind) {
+	if (!has_shared()) integer = other.integer;
+	else if (other.shared && other.shared->leaked)
+		new (&shared) Cow_Ptr<Shared>(other.shared->clone());
+	else
+		new (&shared) Cow_Ptr<Shared>(other.shared);
+}
+dyn_struct::Value::Value(Value&& other) noexcept : kind(other.kind) {
+	if (has_shared()) new (&shared) Cow_Ptr<Shared>(std::move(other.shared));
+	else              integer = other.integer;
+	other.~Value();
+	new (&other) Value();
+}
+dyn_struct::Value::~Value() noexcept {
+	if (has_shared()) shared.~Cow_Ptr();
+}
+
+// other can be one of our own children, it's taken before we let go of them.
+dyn_struct::Value& dyn_struct::Value::operator=(const Value& other) noexcept {
+	Value x(other);
+	this->~Value();
+	return *new (this) Value(std::move(x));
+}
+dyn_struct::Value& dyn_struct::Value::operator=(Value&& other) noexcept {
+	if (this == &other) return *this;
+	Value x(std::move(other));
+	this->~Value();
+	return *new (this) Value(std::move(x));
+}
+
+static const dyn_struct::Children* children(const dyn_struct& x) noexcept {
+	assert(x.value.kind == Kind::Structure || x.value.kind == Kind::Array);
+	return (const dyn_struct::Children*)x.value.shared.get();
+}
+
+// The children of x, about to be written.
+static dyn_struct::Children& own_children(dyn_struct& x) noexcept {
+	assert(x.value.kind == Kind::Structure || x.value.kind == Kind::Array);
+	auto& shared = x.value.shared;
+	if (!shared) shared = new dyn_struct::Children(x.value.kind == Kind::Structure);
+	return (dyn_struct::Children&)shared.write();
+}
+
+// The children of x, one of them is about to be handed out by reference.
+static dyn_struct::Children& leak_children(dyn_struct& x) noexcept {
+	auto& c = own_children(x);
+	c.leaked = true;
+	return c;
+}
+
+void dyn_struct::detach() noexcept {
+	if (value.has_shared() && value.shared) value.shared.write();
 }
 
 dyn_struct::dyn_struct(
 std::initializer_list<std::pair<std::string, dyn_struct>> list
 ) noexcept {
-	structure_t str;
-	for (auto&[k, v] : list) {
-		str[k] = ValuePtr(new dyn_struct(v));
-	}
-	value = str;
+	*this = structure_t{};
+	for (auto&[k, v] : list) (*this)[k] = v;
 }
 
 dyn_struct* dyn_struct::clone() noexcept {
 	return new dyn_struct(*this);
 }
 
-dyn_struct& dyn_struct::operator[](std::string_view str) noexcept {
-	assert(std::holds_alternative<structure_t>(value));
+size_t dyn_struct::child_count() const noexcept {
+	if (value.kind != Kind::Structure && value.kind != Kind::Array) return 0;
+	return value.shared ? children(*this)->size : 0;
+}
+dyn_struct& dyn_struct::child(size_t i) noexcept {
+	assert(i < child_count());
+	return leak_children(*this).at(i);
+}
+const dyn_struct& dyn_struct::child(size_t i) const noexcept {
+	assert(i < child_count());
+	return const_cast<Children*>(children(*this))->at(i);
+}
+xstd::Interned dyn_struct::key(size_t i) const noexcept {
+	assert(value.kind == Kind::Structure && i < child_count());
+	return const_cast<Children*>(children(*this))->key_at(i);
+}
+const dyn_struct* dyn_struct::find(xstd::Interned k) const noexcept {
+	if (value.kind != Kind::Structure || !value.shared) return nullptr;
+	auto i = children(*this)->index_of(k);
+	return i == SIZE_MAX ? nullptr : &child(i);
+}
 
-	auto& struc = std::get<structure_t>(value);
+dyn_struct& dyn_struct::operator[](std::string_view str) noexcept {
+	assert(value.kind == Kind::Structure);
 
+	auto k = xstd::intern(str);
+	auto& c = leak_children(*this);
+	if (auto i = c.index_of(k); i != SIZE_MAX) return c.at(i);
 
-	if (!struc.contains(std::string(str))) set(str, {}, *this);
-	return *struc.at(std::string(str));
+	auto& x = c.append();
+	c.key_at(c.size - 1) = k;
+	return x;
 }
 dyn_struct& dyn_struct::operator[](size_t idx) noexcept {
-	assert(std::holds_alternative<array_t>(value));
-	assert(std::get<array_t>(value).size() > idx);
-
-	auto& arr = std::get<array_t>(value);
-	return *arr[idx];
+	assert(value.kind == Kind::Array);
+	assert(child_count() > idx);
+	return leak_children(*this).at(idx);
 }
 
 const dyn_struct& dyn_struct::operator[](std::string_view str) const noexcept {
-	assert(std::holds_alternative<structure_t>(value));
+	assert(value.kind == Kind::Structure);
 
-	auto& struc = std::get<structure_t>(value);
-	return *struc.at(std::string(str));
+	auto k = xstd::find_interned(str);
+	assert(k && find(*k));
+	return *find(*k);
 }
 const dyn_struct& dyn_struct::operator[](size_t idx) const noexcept {
-	assert(std::holds_alternative<array_t>(value));
-	assert(std::get<array_t>(value).size() > idx);
-
-	auto& arr = std::get<array_t>(value);
-	return *arr[idx];
+	assert(value.kind == Kind::Array);
+	assert(child_count() > idx);
+	return child(idx);
 }
 
 void dyn_struct::push_back(const dyn_struct& v) noexcept {
-	assert(std::holds_alternative<array_t>(value));
-
-	std::get<array_t>(value).push_back({ ValuePtr(new dyn_struct(v)) });
+	assert(value.kind == Kind::Array);
+	// v can be this or one of its children, it's shared before this is detached.
+	dyn_struct x = v;
+	own_children(*this).append() = std::move(x);
 }
 
 void dyn_struct::pop_back() noexcept {
-	assert(std::holds_alternative<array_t>(value));
-	assert(!std::get<array_t>(value).empty());
-	std::get<array_t>(value).pop_back();
+	assert(value.kind == Kind::Array);
+	assert(child_count() > 0);
+	auto& c = own_children(*this);
+	c.at(--c.size) = dyn_struct{};
 }
 
 dyn_struct& get(std::string_view str, const dyn_struct& d_struct) noexcept {
-	assert(std::holds_alternative<dyn_struct::structure_t>(d_struct.value));
-	return *std::get<dyn_struct::structure_t>(d_struct.value).at(str.data());
+	assert(d_struct.value.kind == Kind::Structure);
+	return const_cast<dyn_struct&>(d_struct[str]);
 }
 
 dyn_struct& set(std::string_view str, const dyn_struct& value, dyn_struct& to) noexcept {
-	assert(std::holds_alternative<dyn_struct::structure_t>(to.value));
-	std::get<dyn_struct::structure_t>(to.value).emplace(
-		std::string(str), ValuePtr(new dyn_struct(value))
-	);
+	assert(to.value.kind == Kind::Structure);
+	auto k = xstd::intern(str);
+	dyn_struct x = value;
+	auto& c = own_children(to);
+	if (c.index_of(k) != SIZE_MAX) return to;
+
+	c.append() = std::move(x);
+	c.key_at(c.size - 1) = k;
 	return to;
 }
 
-#define X(x)\
-void to_dyn_struct(dyn_struct& to, const dyn_struct::x& from) noexcept {\
-	dyn_struct::variant v;\
-	v = from;\
-	to.value = std::move(v);\
-}\
-void from_dyn_struct(const dyn_struct& from, dyn_struct::x& to) noexcept {\
-	to = std::get<dyn_struct::x>(from.value);\
-}\
-
-X(integer_t)
-X(real_t)
-X(string_t)
-X(boolean_t)
-X(structure_t)
-X(array_t)
-
-#undef X
+static dyn_struct::integer_t get_integer(const dyn_struct& from) noexcept {
+	assert(holds_number(from));
+	if (from.value.kind == Kind::Real) return (dyn_struct::integer_t)from.value.real;
+	return from.value.integer;
+}
+static double get_real(const dyn_struct& from) noexcept {
+	assert(holds_number(from));
+	if (from.value.kind == Kind::Integer) return (double)from.value.integer;
+	return from.value.real;
+}
 
 #define X(x)\
 void to_dyn_struct(dyn_struct& to, const x& from) noexcept {\
-	dyn_struct::variant v;\
-	v = dyn_struct::integer_t(from);\
-	to.value = std::move(v);\
+	to.value = dyn_struct::Value(Kind::Integer);\
+	to.value.integer = (dyn_struct::integer_t)from;\
 }\
 void from_dyn_struct(const dyn_struct& from, x& to) noexcept {\
-	to = (x)(std::get<dyn_struct::integer_t>(from.value));\
+	to = (x)get_integer(from);\
 }\
 
+X(dyn_struct::integer_t)
 X(int)
 X(long)
 X(unsigned)
@@ -128,121 +267,130 @@ X(unsigned short)
 
 #define X(x)\
 void to_dyn_struct(dyn_struct& to, const x& from) noexcept {\
-	dyn_struct::variant v;\
-	v = dyn_struct::real_t(from);\
-	to.value = std::move(v);\
+	to.value = dyn_struct::Value(Kind::Real);\
+	to.value.real = (double)from;\
 }\
 void from_dyn_struct(const dyn_struct& from, x& to) noexcept {\
-	if (holds_real(from)) {\
-		to = (x)dyn_struct::real_t(from);\
-	}\
-	else if (holds_integer(from)) {\
-		to = (x)dyn_struct::integer_t(from); \
-	}\
-	else {\
-		assert(false);\
-	}\
+	to = (x)get_real(from);\
 }\
 
+X(dyn_struct::real_t)
 X(float)
 X(double)
 
 #undef X
 
-void to_dyn_struct(dyn_struct& to, const dyn_struct::variant& from) noexcept {
-	dyn_struct::variant v;
-	v = from;
-	to.value = std::move(v);
+void to_dyn_struct(dyn_struct& to, const dyn_struct::boolean_t& from) noexcept {
+	to.value = dyn_struct::Value(Kind::Boolean);
+	to.value.boolean = from;
 }
-void from_dyn_struct(const dyn_struct& from, dyn_struct::variant& to) noexcept {
-	to = from.value;
+void from_dyn_struct(const dyn_struct& from, dyn_struct::boolean_t& to) noexcept {
+	assert(holds_bool(from));
+	to = from.value.boolean;
 }
 
-void to_dyn_struct(dyn_struct& to, const dyn_struct::null_t& from) noexcept {
-	dyn_struct::variant v;
-	v = from;
-	to.value = std::move(v);
+void to_dyn_struct(dyn_struct& to, const dyn_struct::string_t& from) noexcept {
+	auto s = new dyn_struct::String;
+	s->string = from;
+	to.value = dyn_struct::Value(Kind::String, s);
+}
+void from_dyn_struct(const dyn_struct& from, dyn_struct::string_t& to) noexcept {
+	assert(holds_string(from));
+	to = ((const dyn_struct::String*)from.value.shared.get())->string;
 }
-void from_dyn_struct(const dyn_struct&, dyn_struct::null_t&) noexcept {}
 
 void to_dyn_struct(dyn_struct& to, char const* from) noexcept {
-	dyn_struct::variant v;
-	v = std::string(from);
-	to.value = std::move(v);
+	to_dyn_struct(to, std::string(from));
+}
+
+void to_dyn_struct(dyn_struct& to, const dyn_struct::null_t&) noexcept {
+	to.value = dyn_struct::Value();
+}
+void from_dyn_struct(const dyn_struct&, dyn_struct::null_t&) noexcept {}
+
+void to_dyn_struct(dyn_struct& to, const dyn_struct::structure_t&) noexcept {
+	to.value = dyn_struct::Value(Kind::Structure);
+}
+void to_dyn_struct(dyn_struct& to, const dyn_struct::array_t&) noexcept {
+	to.value = dyn_struct::Value(Kind::Array);
+}
+
+static std::string format_string(std::string_view v) noexcept {
+	std::string result = "\"";
+	for (const auto& c : v) {
+		if (c == '\\') result += c;
+		result += c;
+	}
+	result += '"';
+	return result;
 }
 
 std::string format(const dyn_struct& s, std::string_view indent) noexcept {
 	std::string result;
-	std::visit(
-		[&](auto& v) noexcept {
-			using type = std::decay_t<decltype(v)>;
-
-			if constexpr (std::is_same_v<type, dyn_struct::integer_t>) {
-				result = std::to_string(v);
-			}
-			else if constexpr (std::is_same_v<type, dyn_struct::real_t>) {
-				result = std::to_string(v);
+	switch (s.value.kind) {
+		case Kind::Null:
+			result = "null";
+			break;
+		case Kind::Integer:
+			result = std::to_string(s.value.integer);
+			break;
+		case Kind::Real:
+			result = std::to_string(s.value.real);
+			break;
+		case Kind::Boolean:
+			result = s.value.boolean ? "true" : "false";
+			break;
+		case Kind::String:
+			result = format_string(((const dyn_struct::String*)s.value.shared.get())->string);
+			break;
+		case Kind::Array: {
+			result += '[';
+			for (size_t i = 0; i < s.child_count(); ++i) {
+				result += ' ';
+				result += format(s.child(i), indent);
+				result += ',';
 			}
-			else if constexpr (std::is_same_v<type, dyn_struct::boolean_t>) {
-				result = v ? "true" : "false";
+
+			// We replace the trailling comma by a space
+			// [ 0, 1, ..., x,] => [ 0, 1, ..., x ].
+			if (s.child_count() > 0) {
+				result.back() = ' ';
 			}
-			else if constexpr (std::is_same_v<type, dyn_struct::string_t>) {
-				result = '"';
-				for (const auto& c : v) {
-					if (c == '\\') result += c;
-					result += c;
-				}
-				result += '"';
+			result += ']';
+			break;
+		}
+		case Kind::Structure: {
+			if (s.child_count() == 0) {
+				result = "{}";
+				break;
 			}
-			else if constexpr (std::is_same_v<type, dyn_struct::array_t>) {
-				result += '[';
-				for (size_t i = 0; i < v.size(); ++i) {
-					result += ' ';
-					result += format(*v[i], indent);
-					result += ',';
-				}
 
-				// We replace the trailling comma by a space
-				// [ 0, 1, ..., x,] => [ 0, 1, ..., x ].
-				if (!v.empty()) {
-					result.back() = ' ';
-				}
-				result += ']';
-			}
-			else if constexpr (std::is_same_v<type, dyn_struct::structure_t>) {
-				if (v.empty()) {
-					result = "{}";
-					return;
+			result += "{\n";
+			for (size_t i = 0; i < s.child_count(); ++i) {
+				result += indent;
+				result += s.key(i).view();
+				result += ": ";
+
+				std::string to_indent = format(s.child(i), indent);
+				for (size_t i = 0; i < to_indent.size(); ++i) {
+					if (to_indent[i] != '\n') continue;
+					to_indent.insert(
+						std::begin(to_indent) + i + 1, std::begin(indent), std::end(indent)
+					);
 				}
 
-				result += "{\n";
-				for (auto&[key, value] : v) {
-					result += indent;
-					result += key;
-					result += ": ";
-
-					std::string to_indent = format(*value, indent);
-					for (size_t i = 0; i < to_indent.size(); ++i) {
-						if (to_indent[i] != '\n') continue;
-						to_indent.insert(
-							std::begin(to_indent) + i + 1, std::begin(indent), std::end(indent)
-						);
-					}
+				result += std::move(to_indent);
 
-					result += std::move(to_indent);
+				result += "\n";
+			}
 
-					result += "\n";
-				}
+			result += "}";
+			break;
+		}
+		default:
+			std::abort();
+	}
 
-				result += "}";
-			}
-			else {
-				std::abort();
-			}
-		},
-		s.value
-	);
-    
 	return result;
 }
 
@@ -250,86 +398,82 @@ constexpr auto __type_tag__ = "__type_tag__";
 constexpr auto __value__ = "__value__";
 
 std::string format_to_json(const dyn_struct& s, std::string_view indent) noexcept {
-	std::string result;
-
-	std::visit([&](auto& v) noexcept {
-		using type = std::decay_t<decltype(v)>;
+	if (s.type_tag != "dyn_struct"_id) {
+		dyn_struct copy = s;
+		copy.type_tag = "dyn_struct"_id;
+		return format_to_json({
+			{__type_tag__, s.type_tag},
+			{__value__, copy}
+		}, indent);
+	}
 
-		if constexpr (std::is_same_v<type, dyn_struct::integer_t>) {
-			result = std::to_string(v);
-		}
-		else if constexpr (std::is_same_v<type, dyn_struct::real_t>) {
-			result = std::to_string(v);
-		}
-		else if constexpr (std::is_same_v<type, dyn_struct::boolean_t>) {
-			result = v ? "true" : "false";
-		}
-		else if constexpr (std::is_same_v<type, dyn_struct::string_t>) {
-			result = '"';
-			for (const auto& c : v) {
-				if (c == '\\') result += c;
-				result += c;
-			}
-			result += '"';
-		}
-		else if constexpr (std::is_same_v<type, dyn_struct::array_t>) {
+	std::string result;
+	switch (s.value.kind) {
+		case Kind::Null:
+			result = "null";
+			break;
+		case Kind::Integer:
+			result = std::to_string(s.value.integer);
+			break;
+		case Kind::Real:
+			result = std::to_string(s.value.real);
+			break;
+		case Kind::Boolean:
+			result = s.value.boolean ? "true" : "false";
+			break;
+		case Kind::String:
+			result = format_string(((const dyn_struct::String*)s.value.shared.get())->string);
+			break;
+		case Kind::Array: {
 			result += '[';
-			for (size_t i = 0; i < v.size(); ++i) {
+			for (size_t i = 0; i < s.child_count(); ++i) {
 				result += ' ';
-				result += format_to_json(*v[i], indent);
+				result += format_to_json(s.child(i), indent);
 				result += ',';
 			}
 			// We replace the trailling comma by a space
 			// [ 0, 1, ..., x,] => [ 0, 1, ..., x ].
-			if (!v.empty()) {
+			if (s.child_count() > 0) {
 				result.back() = ' ';
 			}
 			result += ']';
+			break;
 		}
-		else if constexpr (std::is_same_v<type, dyn_struct::structure_t>) {
-			if (v.empty()) {
+		case Kind::Structure: {
+			if (s.child_count() == 0) {
 				result = "{}";
-				return;
+				break;
 			}
 
 			result += "{";
-			for (auto&[key, value] : v) {
-				result += "";
+			for (size_t i = 0; i < s.child_count(); ++i) {
 				result += indent;
 				result += '"';
-				result += key;
+				result += s.key(i).view();
 				result += '"';
 				result += ": ";
 
-				std::string to_indent = format_to_json(*value, indent);
+				std::string to_indent = format_to_json(s.child(i), indent);
 				for (size_t i = 0; i < to_indent.size(); ++i) {
 					if (to_indent[i] != '\n') continue;
 					to_indent.insert(
 						std::begin(to_indent) + i + 1, std::begin(indent), std::end(indent)
 					);
 				}
-			result += std::move(to_indent);
-			result += ',';
+				result += std::move(to_indent);
+				result += ',';
 			}
 			result.pop_back();
 			result += "}";
-
+			break;
 		}
-		else {
+		default:
 			std::abort();
-		}
-	}, s.value);
-
-	if (s.type_tag != "dyn_struct"_id) {
-		dyn_struct copy = s;
-		copy.type_tag = "dyn_struct"_id;
-		return format_to_json({
-			{__type_tag__, s.type_tag},
-			{__value__, copy}
-		}, indent);
 	}
+
 	return result;
 }
+
 std::string format_to_json(const dyn_struct& s, size_t space_indent) noexcept {
 	std::string str(space_indent, ' ');
 	return format_to_json(s, str);
@@ -485,8 +629,8 @@ std::optional<dyn_struct> load_from_json_file(const std::filesystem::path& file)
 					std::begin(bytes) + tokens[idx].idx + tokens[idx].size
 					);
 				auto number = std::atof(str.data());
-				if (fmod(number, 1.0) == 0) result.value = dyn_struct::integer_t(number);
-				else result.value = dyn_struct::real_t(number);
+				if (fmod(number, 1.0) == 0) result = dyn_struct::integer_t(number);
+				else result = dyn_struct::real_t(number);
 
 				return std::pair{ result, idx + 1 };
 			}
@@ -495,13 +639,13 @@ std::optional<dyn_struct> load_from_json_file(const std::filesystem::path& file)
 			case token_type::OPEN_BRACKET:
 			return construct_array(tokens, idx);
 			case token_type::TRUE:
-			result.value = true;
+			result = true;
 			return std::pair{ result, idx + 1 };
 			case token_type::FALSE:
-			result.value = false;
+			result = false;
 			return std::pair{ result, idx + 1 };
 			case token_type::NULL_JSON:
-			result.value = nullptr;
+			result = nullptr;
 			return std::pair{ result, idx + 1 };
 			default:
 			return std::nullopt;
@@ -515,16 +659,13 @@ std::optional<dyn_struct> load_from_json_file(const std::filesystem::path& file)
 		if (tokens[idx].type != token_type::OPEN_CURLY) return std::nullopt;
 		idx++;
 		dyn_struct result;
-		result.value = dyn_struct::structure_t{};
+		result = dyn_struct::structure_t{};
 
 		if (idx >= tokens.size()) return std::nullopt;
 
 		while (tokens[idx].type != token_type::CLOSE_CURLY) {
 			if (tokens[idx].type != token_type::STRING) return std::nullopt;
-			std::string key(
-				std::begin(bytes) + tokens[idx].idx,
-				std::begin(bytes) + tokens[idx].idx + tokens[idx].size
-			);
+			std::string_view key((const char*)bytes.data() + tokens[idx].idx, tokens[idx].size);
 			idx++;
 
 			if (idx >= tokens.size()) return std::nullopt;
@@ -566,7 +707,7 @@ std::optional<dyn_struct> load_from_json_file(const std::filesystem::path& file)
 		if (tokens[idx].type != token_type::OPEN_BRACKET) return std::nullopt;
 		idx++;
 		dyn_struct result;
-		result.value = dyn_struct::array_t{};
+		result = dyn_struct::array_t{};
         
 		if (idx >= tokens.size()) return std::nullopt;
         
@@ -595,10 +736,10 @@ std::optional<dyn_struct> load_from_json_file(const std::filesystem::path& file)
 	return result->first;
 }
 
+
 size_t
 save_to_json_file(const dyn_struct& to_save, const std::filesystem::path& path) noexcept {
-	if (!std::holds_alternative<dyn_struct::structure_t>(to_save.value))
-		return dyn_struct_error::NOT_AN_OBJECT;
+	if (!holds_object(to_save)) return dyn_struct_error::NOT_AN_OBJECT;
 
 	std::string to_write = format_to_json(to_save);
 
@@ -606,104 +747,104 @@ save_to_json_file(const dyn_struct& to_save, const std::filesystem::path& path)
 }
 
 const dyn_struct& dyn_struct_array_iterator::operator*() const noexcept {
-	return **iterator;
+	return ((const dyn_struct*)parent)->child(i);
 }
 const dyn_struct& dyn_struct_const_array_iterator::operator*() const noexcept {
-	return **iterator;
+	return parent->child(i);
 }
 dyn_struct& dyn_struct_array_iterator::operator*() noexcept {
-	return **iterator;
+	return parent->child(i);
 }
 const dyn_struct& dyn_struct_array_iterator::operator->() const noexcept {
-	return **iterator;
+	return ((const dyn_struct*)parent)->child(i);
 }
 const dyn_struct& dyn_struct_const_array_iterator::operator->() const noexcept {
-	return **iterator;
+	return parent->child(i);
 }
 dyn_struct& dyn_struct_array_iterator::operator->() noexcept {
-	return **iterator;
+	return parent->child(i);
 }
 dyn_struct_array_iterator& dyn_struct_array_iterator::operator++() noexcept {
-	++iterator;
+	++i;
 	return *this;
 }
 dyn_struct_const_array_iterator& dyn_struct_const_array_iterator::operator++() noexcept {
-	++iterator;
+	++i;
 	return *this;
 }
 bool dyn_struct_array_iterator::operator==(const dyn_struct_array_iterator& other) const noexcept {
-	return iterator == other.iterator;
+	return i == other.i;
 }
 bool dyn_struct_array_iterator::operator!=(const dyn_struct_array_iterator& other) const noexcept {
-	return iterator != other.iterator;
+	return i != other.i;
 }
 
 bool dyn_struct_const_array_iterator::operator==(
 const dyn_struct_const_array_iterator& other
 ) const noexcept {
-	return iterator == other.iterator;
+	return i == other.i;
 }
 bool dyn_struct_const_array_iterator::operator!=(
 const dyn_struct_const_array_iterator& other
 ) const noexcept {
-	return iterator != other.iterator;
+	return i != other.i;
 }
 
-std::pair<std::string, dyn_struct&> dyn_struct_structure_iterator::operator*() noexcept {
-	return std::pair<std::string, dyn_struct&>{ iterator->first, *iterator->second };
+std::pair<std::string_view, dyn_struct&> dyn_struct_structure_iterator::operator*() noexcept {
+	return { parent->key(i).view(), parent->child(i) };
 }
-std::pair<std::string, dyn_struct&>
+std::pair<std::string_view, dyn_struct&>
 dyn_struct_structure_iterator::operator->() noexcept {
-	return std::pair<std::string, dyn_struct&>{ iterator->first, *iterator->second };
+	return { parent->key(i).view(), parent->child(i) };
 }
 dyn_struct_structure_iterator& dyn_struct_structure_iterator::operator++() noexcept {
-	++iterator;
+	++i;
 	return *this;
 }
 bool dyn_struct_structure_iterator::operator==(
 	const dyn_struct_structure_iterator& other
 ) const noexcept {
-	return iterator == other.iterator;
+	return i == other.i;
 }
 bool dyn_struct_structure_iterator::operator!=(
 	const dyn_struct_structure_iterator& other
 ) const noexcept {
-	return iterator != other.iterator;
+	return i != other.i;
 }
 
-std::pair<std::string, const dyn_struct&>
+std::pair<std::string_view, const dyn_struct&>
 dyn_struct_const_structure_iterator::operator*() noexcept {
-	return std::pair<std::string, const dyn_struct&>{ iterator->first, *iterator->second };
+	return { parent->key(i).view(), parent->child(i) };
 }
-std::pair<std::string, const dyn_struct&>
+std::pair<std::string_view, const dyn_struct&>
 dyn_struct_const_structure_iterator::operator->() noexcept {
-	return std::pair<std::string, const dyn_struct&>{ iterator->first, *iterator->second };
+	return { parent->key(i).view(), parent->child(i) };
 }
 dyn_struct_const_structure_iterator& dyn_struct_const_structure_iterator::operator++() noexcept {
-	++iterator;
+	++i;
 	return *this;
 }
 bool dyn_struct_const_structure_iterator::operator==(
 	const dyn_struct_const_structure_iterator& other
 ) const noexcept {
-	return iterator == other.iterator;
+	return i == other.i;
 }
 bool dyn_struct_const_structure_iterator::operator!=(
 	const dyn_struct_const_structure_iterator& other
 ) const noexcept {
-	return iterator != other.iterator;
+	return i != other.i;
 }
 
 const dyn_struct* at(const dyn_struct& d_struct, std::string_view key) noexcept {
-	if (!has(d_struct, key)) return nullptr;
-	return &d_struct[key];
+	auto k = xstd::find_interned(key);
+	return k ? d_struct.find(*k) : nullptr;
 }
 
 constexpr bool holds_object(const dyn_struct& d_struct) noexcept {
-	return std::holds_alternative<dyn_struct::structure_t>(d_struct.value);
+	return d_struct.value.kind == Kind::Structure;
 }
 constexpr bool holds_array(const dyn_struct& d_struct) noexcept {
-	return std::holds_alternative<dyn_struct::array_t>(d_struct.value);
+	return d_struct.value.kind == Kind::Array;
 }
 
 constexpr bool holds_primitive(const dyn_struct& d_struct) noexcept {
@@ -714,19 +855,19 @@ constexpr bool holds_primitive(const dyn_struct& d_struct) noexcept {
 		holds_string(d_struct);
 }
 constexpr bool holds_integer(const dyn_struct& d_struct) noexcept {
-	return std::holds_alternative<dyn_struct::integer_t>(d_struct.value);
+	return d_struct.value.kind == Kind::Integer;
 }
 constexpr bool holds_real(const dyn_struct& d_struct) noexcept {
-	return std::holds_alternative<dyn_struct::real_t>(d_struct.value);
+	return d_struct.value.kind == Kind::Real;
 }
 constexpr bool holds_bool(const dyn_struct& d_struct) noexcept {
-	return std::holds_alternative<dyn_struct::boolean_t>(d_struct.value);
+	return d_struct.value.kind == Kind::Boolean;
 }
 constexpr bool holds_null(const dyn_struct& d_struct) noexcept {
-	return std::holds_alternative<dyn_struct::null_t>(d_struct.value);
+	return d_struct.value.kind == Kind::Null;
 }
 constexpr bool holds_string(const dyn_struct& d_struct) noexcept {
-	return std::holds_alternative<dyn_struct::string_t>(d_struct.value);
+	return d_struct.value.kind == Kind::String;
 }
 constexpr bool holds_number(const dyn_struct& d_struct) noexcept {
 	return holds_integer(d_struct) || holds_real(d_struct);
@@ -734,70 +875,69 @@ constexpr bool holds_number(const dyn_struct& d_struct) noexcept {
 
 const dyn_struct_const_array_iterator
 begin(const dyn_struct_const_array_iterator_tag& d_struct) noexcept {
-	return { d_struct.it->cbegin() };
+	return { d_struct.it, 0 };
 }
 dyn_struct_array_iterator begin(const dyn_struct_array_iterator_tag& d_struct) noexcept {
-	return { d_struct.it->begin() };
+	return { d_struct.it, 0 };
 }
 const dyn_struct_const_array_iterator
 end(const dyn_struct_const_array_iterator_tag& d_struct) noexcept {
-	return { d_struct.it->cend() };
+	return { d_struct.it, d_struct.it->child_count() };
 }
 dyn_struct_array_iterator end(const dyn_struct_array_iterator_tag& d_struct) noexcept {
-	return { d_struct.it->end() };
+	return { d_struct.it, d_struct.it->child_count() };
 }
 
 const dyn_struct_const_structure_iterator
 begin(const dyn_struct_const_structure_iterator_tag& d_struct) noexcept {
-	return { d_struct.it->begin() };
+	return { d_struct.it, 0 };
 }
 dyn_struct_structure_iterator begin(const dyn_struct_structure_iterator_tag& d_struct) noexcept {
-	return { d_struct.it->begin() };
+	return { d_struct.it, 0 };
 }
 const dyn_struct_const_structure_iterator
 end(const dyn_struct_const_structure_iterator_tag& d_struct) noexcept {
-	return { d_struct.it->end() };
+	return { d_struct.it, d_struct.it->child_count() };
 }
 dyn_struct_structure_iterator end(const dyn_struct_structure_iterator_tag& d_struct) noexcept {
-	return { d_struct.it->end() };
+	return { d_struct.it, d_struct.it->child_count() };
 }
 
 dyn_struct_array_iterator_tag iterate_array(dyn_struct& d_struct) noexcept {
-	assert(std::holds_alternative<dyn_struct::array_t>(d_struct.value));
-	return { &std::get<dyn_struct::array_t>(d_struct.value) };
+	assert(holds_array(d_struct));
+	d_struct.detach();
+	return { &d_struct };
 }
 dyn_struct_const_array_iterator_tag iterate_array(const dyn_struct& d_struct) noexcept
 {
-	assert(std::holds_alternative<dyn_struct::array_t>(d_struct.value));
-	return { &std::get<dyn_struct::array_t>(d_struct.value) };
+	assert(holds_array(d_struct));
+	return { &d_struct };
 }
 
 
 dyn_struct_structure_iterator_tag iterate_structure(dyn_struct& d_struct) noexcept {
-	assert(std::holds_alternative<dyn_struct::structure_t>(d_struct.value));
-	return { &std::get<dyn_struct::structure_t>(d_struct.value) };
+	assert(holds_object(d_struct));
+	d_struct.detach();
+	return { &d_struct };
 }
 
 dyn_struct_const_structure_iterator_tag iterate_structure(const dyn_struct& d_struct) noexcept {
-	assert(std::holds_alternative<dyn_struct::structure_t>(d_struct.value));
-	return { &std::get<dyn_struct::structure_t>(d_struct.value) };
+	assert(holds_object(d_struct));
+	return { &d_struct };
 }
 
 
 bool has(const dyn_struct& d_struct, std::string_view key) noexcept {
-	return std::holds_alternative<dyn_struct::structure_t>(d_struct.value) &&
-		std::get<dyn_struct::structure_t>(d_struct.value).contains(std::string{ key });
+	return at(d_struct, key) != nullptr;
 }
 
 dyn_struct dyn_struct_array(size_t n) noexcept {
-	dyn_struct d;
-	d.value = dyn_struct::array_t(n);
+	dyn_struct d = dyn_struct::array_t{};
+	for (size_t i = 0; i < n; ++i) d.push_back({});
 	return d;
 }
 
 size_t size(const dyn_struct& d_struct) noexcept {
-	if (holds_array(d_struct)) return std::get<dyn_struct::array_t>(d_struct.value).size();
-	if (holds_object(d_struct))
-		return std::get<dyn_struct::structure_t>(d_struct.value).size();
+	if (holds_array(d_struct) || holds_object(d_struct)) return d_struct.child_count();
 	return 1;
 }
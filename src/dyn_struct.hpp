@@ -3,28 +3,85 @@
 
 #include <any>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
 #include <variant>
 #include <optional>
 #include <filesystem>
 
+#include "std/interned.hpp"
 #include "std/unordered_map.hpp"
-#include "Memory/ValuePtr.hpp"
+#include "Memory/Cow_Ptr.hpp"
 
 #include "xstd.hpp"
 
+// A JSON like tree. Every node is a tagged 16 bytes Value, numbers and booleans are in there,
+// strings and containers point to a refcounted part that copies share: copying a dyn_struct is
+// O(1) and what is about to be written is detached first, copy on write.
+// The children of a container are stored by value, in segments of 4, 8, 16... that never move,
+// so a reference from operator[] stays good while siblings are added. Once one was handed out
+// the children are never shared again, like the copy on write std::string after it leaked a
+// reference: a copy of the parent made later gets its own, and what is written through the
+// reference doesn't show in it. That copy is one level deep, what is below is still shared.
+// Structure keys are interned and kept in insertion order.
 struct dyn_struct {
 	using integer_t = long long int;
 	using real_t = long double;
 	using string_t = std::string;
 	using boolean_t = bool;
-	using structure_t = xstd::unordered_map<std::string, ValuePtr<dyn_struct>>;
-	using array_t = std::vector<ValuePtr<dyn_struct>>;
 	using null_t = std::nullptr_t;
 
-	using variant =
-		std::variant<integer_t, real_t, string_t, boolean_t, structure_t, array_t, null_t>;
+	// Only there to say what to make, dyn_struct x = dyn_struct::structure_t{};
+	struct structure_t {};
+	struct array_t {};
+
+	enum class Kind : std::uint8_t {
+		Null = 0,
+		Integer,
+		Real,
+		Boolean,
+		String,
+		Structure,
+		Array
+	};
+
+	// What strings and containers share, a String or Children.
+	struct Shared : Ref_Counted<> {
+		// A mutable reference into it was handed out, it's copied instead of shared.
+		bool leaked = false;
+
+		Shared() noexcept = default;
+		// Nobody holds a reference into a fresh copy.
+		Shared(const Shared& other) noexcept : Ref_Counted(other) {}
+		virtual ~Shared() noexcept = default;
+		virtual Shared* clone() const noexcept = 0;
+	};
+	struct String;
+	struct Children;
+
+	struct Value {
+		union {
+			integer_t integer;
+			double real;
+			bool boolean;
+			// Strings and containers, null for an empty one.
+			Cow_Ptr<Shared> shared;
+		};
+		Kind kind = Kind::Null;
+
+		Value() noexcept : integer(0) {}
+		explicit Value(Kind kind, Shared* shared = nullptr) noexcept;
+		Value(const Value& other) noexcept;
+		Value(Value&& other) noexcept;
+		~Value() noexcept;
+
+		Value& operator=(const Value& other) noexcept;
+		Value& operator=(Value&& other) noexcept;
+
+		bool has_shared() const noexcept { return kind >= Kind::String; }
+	};
+	static_assert(sizeof(Value) == 16);
 
 	dyn_struct() = default;
 
@@ -35,13 +92,8 @@ struct dyn_struct {
 	dyn_struct& operator=(dyn_struct&&) = default;
 	template<typename T>
 	dyn_struct(std::initializer_list<T> list) noexcept {
-		array_t array;
-
-		for (auto& x : list) {
-			array.push_back({ new dyn_struct(x) });
-		}
-
-		value = array;
+		*this = array_t{};
+		for (auto& x : list) push_back(dyn_struct(x));
 	}
 
 	dyn_struct(std::initializer_list<std::pair<std::string, dyn_struct>> list) noexcept;
@@ -74,25 +126,38 @@ struct dyn_struct {
 
 	dyn_struct* clone() noexcept;
 
+	// Children of a structure or an array, by position.
+	size_t child_count() const noexcept;
+	dyn_struct& child(size_t i) noexcept;
+	const dyn_struct& child(size_t i) const noexcept;
+	xstd::Interned key(size_t i) const noexcept;
+	const dyn_struct* find(xstd::Interned key) const noexcept;
+
+	// Makes sure nothing else shares what this points to before it's written.
+	void detach() noexcept;
+
+	// Before value, the defaulted assignment copies it first: x = x["child"] lets go of the
+	// child when it gets to value.
 	size_t type_tag{ "dyn_struct"_id };
-	variant value;
+	Value value;
 };
 
 struct dyn_struct_array_iterator_tag {
-	dyn_struct::array_t* it;
+	dyn_struct* it;
 };
 struct dyn_struct_const_array_iterator_tag {
-	const dyn_struct::array_t* it;
+	const dyn_struct* it;
 };
 struct dyn_struct_structure_iterator_tag {
-	dyn_struct::structure_t* it;
+	dyn_struct* it;
 };
 struct dyn_struct_const_structure_iterator_tag {
-	const dyn_struct::structure_t* it;
+	const dyn_struct* it;
 };
 
 struct dyn_struct_array_iterator {
-	dyn_struct::array_t::iterator iterator;
+	dyn_struct* parent;
+	size_t i;
 
 	const dyn_struct& operator*() const noexcept;
 	dyn_struct& operator*() noexcept;
@@ -104,7 +169,8 @@ struct dyn_struct_array_iterator {
 	bool operator!=(const dyn_struct_array_iterator& other) const noexcept;
 };
 struct dyn_struct_const_array_iterator {
-	dyn_struct::array_t::const_iterator iterator;
+	const dyn_struct* parent;
+	size_t i;
 
 	const dyn_struct& operator*() const noexcept;
 	const dyn_struct& operator->() const noexcept;
@@ -114,20 +180,22 @@ struct dyn_struct_const_array_iterator {
 	bool operator!=(const dyn_struct_const_array_iterator& other) const noexcept;
 };
 struct dyn_struct_structure_iterator {
-	dyn_struct::structure_t::iterator iterator;
+	dyn_struct* parent;
+	size_t i;
 
-	std::pair<std::string, dyn_struct&> operator*() noexcept;
-	std::pair<std::string, dyn_struct&> operator->() noexcept;
+	std::pair<std::string_view, dyn_struct&> operator*() noexcept;
+	std::pair<std::string_view, dyn_struct&> operator->() noexcept;
 
 	dyn_struct_structure_iterator& operator++() noexcept;
 	bool operator==(const dyn_struct_structure_iterator& other) const noexcept;
 	bool operator!=(const dyn_struct_structure_iterator& other) const noexcept;
 };
 struct dyn_struct_const_structure_iterator {
-	dyn_struct::structure_t::const_iterator iterator;
+	const dyn_struct* parent;
+	size_t i;
 
-	std::pair<std::string, const dyn_struct&> operator*() noexcept;
-	std::pair<std::string, const dyn_struct&> operator->() noexcept;
+	std::pair<std::string_view, const dyn_struct&> operator*() noexcept;
+	std::pair<std::string_view, const dyn_struct&> operator->() noexcept;
 
 	dyn_struct_const_structure_iterator& operator++() noexcept;
 	bool operator==(const dyn_struct_const_structure_iterator& other) const noexcept;
@@ -145,7 +213,7 @@ namespace std {
 	};
 	template<>
 	struct iterator_traits<dyn_struct_structure_iterator> {
-		typedef std::pair<std::string, dyn_struct&> value_type;
+		typedef std::pair<std::string_view, dyn_struct&> value_type;
 		typedef int difference_type;
 		typedef value_type& reference;
 		typedef value_type* pointer;
@@ -161,8 +229,6 @@ X(dyn_struct::integer_t)
 X(dyn_struct::real_t)
 X(dyn_struct::string_t)
 X(dyn_struct::boolean_t)
-X(dyn_struct::array_t)
-X(dyn_struct::structure_t)
 X(dyn_struct::null_t)
 X(int)
 X(long)
@@ -175,6 +241,8 @@ X(float)
 X(double)
 
 #undef X
+extern void to_dyn_struct(dyn_struct&, const dyn_struct::array_t&) noexcept;
+extern void to_dyn_struct(dyn_struct&, const dyn_struct::structure_t&) noexcept;
 extern void to_dyn_struct(dyn_struct&, const char*) noexcept;
 
 extern dyn_struct& get(std::string_view str, const dyn_struct& d_struct) noexcept;
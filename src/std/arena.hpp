@@ -0,0 +1,119 @@
+#pragma once
+
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "int.hpp"
+#include "std/vector.hpp"
+
+namespace xstd {
+
+	// Bump allocator: an allocation is a pointer increment in the current chunk, there is no
+	// free, everything goes at once with reset. Chunks are kept across resets, once the
+	// biggest frame went through it never touches the heap again.
+	struct Arena {
+		struct Chunk {
+			Chunk* next = nullptr;
+			size_t size = 0;
+			size_t used = 0;
+
+			char* data() noexcept { return (char*)(this + 1); }
+		};
+
+		size_t chunk_size = 1 << 20;
+
+		Chunk* first = nullptr;
+		Chunk* current = nullptr;
+
+		// Peak of bytes given out between two resets.
+		size_t used = 0;
+		size_t peak = 0;
+
+		Arena() noexcept = default;
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+		~Arena() noexcept {
+			for (auto c = first; c;) {
+				auto next = c->next;
+				free(c);
+				c = next;
+			}
+		}
+
+		void* allocate(size_t n, size_t align) noexcept {
+			for (; current; current = current->next) {
+				auto base = (uintptr_t)current->data();
+				size_t at = ((base + current->used + align - 1) & ~(uintptr_t)(align - 1)) - base;
+				if (at + n > current->size) continue;
+
+				used += at - current->used + n;
+				if (used > peak) peak = used;
+				current->used = at + n;
+				return current->data() + at;
+			}
+
+			// Nothing left that fits, a new chunk goes at the front and is kept for next time.
+			size_t size = n + align > chunk_size ? n + align : chunk_size;
+			auto c = new (malloc(sizeof(Chunk) + size)) Chunk;
+			c->size = size;
+			c->next = first;
+			first = c;
+			current = c;
+			return allocate(n, align);
+		}
+
+		template<typename T>
+		T* allocate(size_t n) noexcept { return (T*)allocate(n * sizeof(T), alignof(T)); }
+
+		void reset() noexcept {
+			for (auto c = first; c; c = c->next) c->used = 0;
+			current = first;
+			used = 0;
+		}
+	};
+
+	inline Arena*& current_frame_arena() noexcept {
+		thread_local Arena arena;
+		thread_local Arena* current = &arena;
+		return current;
+	}
+
+	// One per thread, each frame loop resets its own thread's at the end of its frame. What is
+	// allocated in it can't be kept for the next frame.
+	inline Arena& frame_arena() noexcept { return *current_frame_arena(); }
+
+	// For a loop of frames run within one frame of the outer loop: while it lives frame_arena()
+	// on this thread is its own arena, the inner loop resets that one and leaves the outer
+	// frame's allocations alone.
+	struct Nested_Frame_Arena {
+		Arena arena;
+		Arena* outer = current_frame_arena();
+
+		Nested_Frame_Arena() noexcept { current_frame_arena() = &arena; }
+		~Nested_Frame_Arena() noexcept { current_frame_arena() = outer; }
+	};
+
+	struct Frame_Allocator {
+		static void* allocate(size_t n, size_t align) noexcept {
+			return frame_arena().allocate(n, align);
+		}
+		static void deallocate(void*, size_t) noexcept {}
+	};
+
+	// Growing one leaves its old storage in the arena until the reset, it's at most twice what
+	// a heap vector would have used.
+	// One kept across frames has to be emptied with = {} before it's used after a reset, clear
+	// would keep its storage in the arena. Before the reset if T has a destructor.
+	template<typename T>
+	using frame_vector = vector<T, Growth_Double, Frame_Allocator>;
+
+	// n value initialized T in the frame arena.
+	template<typename T>
+	span<T> frame_span(size_t n) noexcept {
+		auto data = frame_arena().allocate<T>(n);
+		for (size_t i = 0; i < n; ++i) new (data + i) T();
+		return { data, n };
+	}
+};
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <limits.h>
+#include <functional>
+#include <string>
 #include <type_traits>
 #include "int.hpp"
 
@@ -39,12 +42,21 @@ namespace xstd {
 			return hash_op((size_t)x);
 		}
 	};
+#if ULONG_MAX != UINT64_MAX
+	// On Linux unsigned long is uint64_t, already done above.
 	template<>
 	struct hash<unsigned long> {
 		unsigned long operator()(unsigned long x) noexcept {
 			return x;
 		}
 	};
+#endif
+	template<>
+	struct hash<std::string> {
+		size_t operator()(const std::string& x) noexcept {
+			return std::hash<std::string>()(x);
+		}
+	};
 
 	
 	constexpr inline size_t hash_combine(size_t a, size_t b) noexcept {
@@ -1,19 +1,9 @@
 #pragma once
 
-using int8_t = signed char;
-using uint8_t = unsigned char;
+// The platform's own, so they are the same types its headers use: size_t is unsigned long on
+// Linux and in wasm, and int64_t is long on Linux.
+#include <stddef.h>
+#include <stdint.h>
 
-using int08_t = signed char;
-using int16_t = signed short;
-using int32_t = signed int;
-using int64_t = signed long long int;
-using uint08_t = unsigned char;
-using uint16_t = unsigned short;
-using uint32_t = unsigned int;
-using uint64_t = unsigned long long;
-
-#ifdef __EMSCRIPTEN__
-	using size_t = unsigned long;
-#else
-	using size_t = unsigned long long;
-#endif
+using int08_t = int8_t;
+using uint08_t = uint8_t;
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string_view>
+
+#include "std/arena.hpp"
+#include "std/hash.hpp"
+
+namespace xstd {
+
+	// A string that was put in the global table once and is an index from then on: comparing
+	// two is comparing two u32 and their hash was computed when they went in. The characters
+	// are never freed nor moved, view() stays good for the whole program.
+	// Id 0 is the empty string.
+	struct Interned {
+		std::uint32_t id = 0;
+
+		std::string_view view() const noexcept;
+		// Always null terminated.
+		const char* c_str() const noexcept { return view().data(); }
+		size_t hash() const noexcept;
+
+		bool empty() const noexcept { return id == 0; }
+		bool operator==(Interned other) const noexcept { return id == other.id; }
+		bool operator!=(Interned other) const noexcept { return id != other.id; }
+	};
+
+	// Adding a new string takes a lock, nothing else does: entries are written in chunks that
+	// are never moved before their id is handed out, and strings are found in an open
+	// addressed index of ids that inserts only ever fill, replaced by a bigger copy when it's
+	// half full. Old indices are leaked, a reader might still be in one, together they are
+	// smaller than the last.
+	struct Intern_Table {
+		struct Entry {
+			const char* data = nullptr;
+			std::uint32_t size = 0;
+			size_t hash = 0;
+		};
+
+		struct String_Hash {
+			size_t operator()(std::string_view x) noexcept {
+				return std::hash<std::string_view>()(x);
+			}
+		};
+
+		// Slots hold id + 1, 0 is an empty slot.
+		struct Index {
+			size_t mask = 0;
+			std::atomic<std::uint32_t>* slots = nullptr;
+		};
+
+		static constexpr size_t Chunk_Size = 4096;
+		static constexpr size_t Max_Chunk = 4096;
+
+		std::atomic<Entry*> chunks[Max_Chunk] = {};
+		std::atomic<std::uint32_t> count = 0;
+		std::atomic<Index*> index = nullptr;
+
+		std::mutex mutex;
+		Arena bytes;
+
+		Intern_Table() noexcept {
+			index.store(make_index(1024), std::memory_order_release);
+			insert("");
+		}
+
+		const Entry& entry(std::uint32_t id) const noexcept {
+			return chunks[id / Chunk_Size].load(std::memory_order_acquire)[id % Chunk_Size];
+		}
+
+		std::uint32_t insert(std::string_view x) noexcept {
+			size_t h = String_Hash()(x);
+			if (auto id = lookup(*index.load(std::memory_order_acquire), x, h)) return *id;
+
+			std::lock_guard lock(mutex);
+			auto idx = index.load(std::memory_order_relaxed);
+			if (auto id = lookup(*idx, x, h)) return *id;
+
+			std::uint32_t id = count.load(std::memory_order_relaxed);
+			if (id / Chunk_Size >= Max_Chunk) {
+				fprintf(stderr, "Intern table is full, %zu strings.\n", Chunk_Size * Max_Chunk);
+				abort();
+			}
+
+			auto chunk = chunks[id / Chunk_Size].load(std::memory_order_relaxed);
+			if (!chunk) {
+				chunk = new Entry[Chunk_Size];
+				chunks[id / Chunk_Size].store(chunk, std::memory_order_release);
+			}
+
+			auto data = bytes.allocate<char>(x.size() + 1);
+			memcpy(data, x.data(), x.size());
+			data[x.size()] = 0;
+
+			auto& e = chunk[id % Chunk_Size];
+			e.data = data;
+			e.size = (std::uint32_t)x.size();
+			e.hash = h;
+
+			if (2 * (id + 1) > idx->mask + 1) {
+				auto bigger = make_index(2 * (idx->mask + 1));
+				for (std::uint32_t i = 0; i < id; ++i) place(*bigger, i, entry(i).hash);
+				index.store(bigger, std::memory_order_release);
+				idx = bigger;
+			}
+			place(*idx, id, h);
+
+			count.store(id + 1, std::memory_order_release);
+			return id;
+		}
+
+		std::optional<std::uint32_t> find(std::string_view x) const noexcept {
+			return lookup(*index.load(std::memory_order_acquire), x, String_Hash()(x));
+		}
+
+	private:
+		static Index* make_index(size_t n) noexcept {
+			auto idx = new Index;
+			idx->mask = n - 1;
+			idx->slots = new std::atomic<std::uint32_t>[n];
+			for (size_t i = 0; i < n; ++i) idx->slots[i].store(0, std::memory_order_relaxed);
+			return idx;
+		}
+
+		// The entry of id is written before its slot is.
+		static void place(Index& idx, std::uint32_t id, size_t h) noexcept {
+			size_t i = h & idx.mask;
+			while (idx.slots[i].load(std::memory_order_relaxed)) i = (i + 1) & idx.mask;
+			idx.slots[i].store(id + 1, std::memory_order_release);
+		}
+
+		std::optional<std::uint32_t> lookup(
+			const Index& idx, std::string_view x, size_t h
+		) const noexcept {
+			for (size_t i = h & idx.mask;; i = (i + 1) & idx.mask) {
+				std::uint32_t slot = idx.slots[i].load(std::memory_order_acquire);
+				if (!slot) return std::nullopt;
+
+				auto& e = entry(slot - 1);
+				if (e.hash == h && std::string_view(e.data, e.size) == x) return slot - 1;
+			}
+		}
+	};
+
+	inline Intern_Table& intern_table() noexcept {
+		static Intern_Table table;
+		return table;
+	}
+
+	[[nodiscard]] inline Interned intern(std::string_view x) noexcept {
+		return { intern_table().insert(x) };
+	}
+
+	// Doesn't add x if it isn't there already.
+	[[nodiscard]] inline std::optional<Interned> find_interned(std::string_view x) noexcept {
+		auto id = intern_table().find(x);
+		return id ? std::optional{ Interned{ *id } } : std::nullopt;
+	}
+
+	// Every id below it is valid.
+	inline std::uint32_t interned_count() noexcept {
+		return intern_table().count.load(std::memory_order_acquire);
+	}
+
+	inline std::string_view Interned::view() const noexcept {
+		auto& e = intern_table().entry(id);
+		return { e.data, e.size };
+	}
+	inline size_t Interned::hash() const noexcept {
+		return intern_table().entry(id).hash;
+	}
+
+	template<>
+	struct hash<Interned> {
+		size_t operator()(Interned x) noexcept {
+			return x.hash();
+		}
+	};
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <new>
+#include <stdint.h>
+#include <utility>
+
+namespace xstd {
+
+	// Fixed size slots for one T, for what a sum_type keeps out of line. Slots come in blocks
+	// of Block_Size that are never given back, a freed slot goes on the free list of the thread
+	// that frees it. Fine for what is made and dropped on the same thread, something made on
+	// one thread and always dropped on another makes the first one allocate blocks forever.
+	template<typename T, size_t Block_Size = 64>
+	struct Side_Pool {
+		union Slot {
+			Slot* next;
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+
+		inline static thread_local Slot* free_list = nullptr;
+
+		static void* allocate() noexcept {
+			if (!free_list) {
+				auto block = new Slot[Block_Size];
+				for (size_t i = 0; i + 1 < Block_Size; ++i) block[i].next = block + i + 1;
+				block[Block_Size - 1].next = nullptr;
+				free_list = block;
+			}
+
+			auto slot = free_list;
+			free_list = slot->next;
+			return slot;
+		}
+
+		static void deallocate(void* ptr) noexcept {
+			auto slot = (Slot*)ptr;
+			slot->next = free_list;
+			free_list = slot;
+		}
+	};
+
+	// A T in its Side_Pool, owned: copying it copies the T. Only a pointer big, it's what a
+	// sum_type holds for its boxed kinds. A moved from one is empty.
+	template<typename T>
+	struct Boxed {
+		T* ptr = nullptr;
+
+		Boxed() noexcept : ptr(new (Side_Pool<T>::allocate()) T()) {}
+		Boxed(const T& x) noexcept : ptr(new (Side_Pool<T>::allocate()) T(x)) {}
+		Boxed(T&& x) noexcept : ptr(new (Side_Pool<T>::allocate()) T(std::move(x))) {}
+		Boxed(const Boxed& other) noexcept : Boxed(*other.ptr) {}
+		Boxed(Boxed&& other) noexcept : ptr(other.ptr) { other.ptr = nullptr; }
+		~Boxed() noexcept { reset(); }
+
+		Boxed& operator=(const Boxed& other) noexcept {
+			if (this == &other) return *this;
+			reset();
+			ptr = new (Side_Pool<T>::allocate()) T(*other.ptr);
+			return *this;
+		}
+		Boxed& operator=(Boxed&& other) noexcept {
+			if (this == &other) return *this;
+			reset();
+			ptr = other.ptr;
+			other.ptr = nullptr;
+			return *this;
+		}
+
+		T& operator*() noexcept { return *ptr; }
+		const T& operator*() const noexcept { return *ptr; }
+		T* operator->() noexcept { return ptr; }
+		const T* operator->() const noexcept { return ptr; }
+
+		void reset() noexcept {
+			if (!ptr) return;
+			ptr->~T();
+			Side_Pool<T>::deallocate(ptr);
+			ptr = nullptr;
+		}
+	};
+};
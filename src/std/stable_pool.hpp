@@ -0,0 +1,216 @@
+#pragma once
+
+#include <bit>
+#include <new>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+#include "std/vector.hpp"
+#include "std/unordered_map.hpp"
+#include "Profiler/Counters.hpp"
+
+namespace xstd {
+
+	// Same interface as Pool but an element never moves once it's in: they live in blocks of
+	// Block_Size slots that are only given back on destruction, so a T& or T* taken from it is
+	// good until that element is removed, pushing while iterating included.
+	// A removed element's slot goes at the head of a free list threaded through the free slots
+	// themselves and the next push_back takes it. Which slots are used is one bit per slot,
+	// iterating skips the free ones 64 at a time.
+	// operator[] takes a slot, slots aren't dense: go up to slot_count() and check occupied().
+	template<typename T, size_t Block_Size = 256>
+	struct Stable_Pool {
+		static_assert(Block_Size % 64 == 0);
+		static_assert(sizeof(T) >= sizeof(size_t), "A free slot holds the next free one.");
+
+		static constexpr size_t No_Slot = SIZE_MAX;
+
+		inline static size_t ID = 1;
+
+		struct Block {
+			std::uint64_t occupied[Block_Size / 64] = {};
+			alignas(T) unsigned char storage[Block_Size * sizeof(T)];
+
+			T* at(size_t i) noexcept { return (T*)storage + i; }
+		};
+
+		xstd::vector<Block*> blocks;
+		// Same as Pool, hashmap measured faster than swiss_map for these.
+		xstd::unordered_map<size_t, size_t> pool_ids;
+
+		// Every slot below slots has been used at least once.
+		size_t slots = 0;
+		size_t count = 0;
+		size_t free_head = No_Slot;
+
+		Stable_Pool() noexcept = default;
+		Stable_Pool(const Stable_Pool& other) noexcept { *this = other; }
+		Stable_Pool(Stable_Pool&& other) noexcept { *this = std::move(other); }
+		~Stable_Pool() noexcept {
+			clear();
+			for (auto b : blocks) delete b;
+		}
+
+		// Same slots, same free list, same ids.
+		Stable_Pool& operator=(const Stable_Pool& other) noexcept {
+			if (this == &other) return *this;
+			clear();
+			while (blocks.size() < other.blocks.size()) blocks.push_back(new Block);
+
+			for (size_t i = 0; i < other.slots; ++i) {
+				if (other.occupied(i)) {
+					new (slot(i)) T(other[i]);
+					set_occupied(i, true);
+				} else {
+					memcpy(slot(i), other.slot(i), sizeof(size_t));
+				}
+			}
+			pool_ids = other.pool_ids;
+			slots = other.slots;
+			count = other.count;
+			free_head = other.free_head;
+			return *this;
+		}
+		Stable_Pool& operator=(Stable_Pool&& other) noexcept {
+			if (this == &other) return *this;
+			clear();
+			for (auto b : blocks) delete b;
+
+			blocks = std::move(other.blocks);
+			pool_ids = std::move(other.pool_ids);
+			slots = other.slots;
+			count = other.count;
+			free_head = other.free_head;
+
+			other.blocks = {};
+			other.pool_ids = {};
+			other.slots = 0;
+			other.count = 0;
+			other.free_head = No_Slot;
+			return *this;
+		}
+
+		// Keeps the blocks.
+		void clear() noexcept {
+			for (size_t i = next_occupied(0); i < slots; i = next_occupied(i + 1)) slot(i)->~T();
+			for (auto b : blocks) memset(b->occupied, 0, sizeof(b->occupied));
+			pool_ids.clear();
+			slots = 0;
+			count = 0;
+			free_head = No_Slot;
+		}
+
+		template<typename... Args>
+		T& emplace_back(Args&&... args) noexcept {
+			size_t i = free_head;
+			if (i != No_Slot) {
+				memcpy(&free_head, slot(i), sizeof(size_t));
+			} else {
+				i = slots++;
+				if (i / Block_Size == blocks.size()) blocks.push_back(new Block);
+			}
+
+			auto x = new (slot(i)) T(std::forward<Args>(args)...);
+			set_occupied(i, true);
+			count++;
+
+			pool_ids[ID] = i;
+			if constexpr (has_id<T>::value) x->id = ID;
+			ID++;
+			return *x;
+		}
+		T& push_back(const T& v) noexcept { return emplace_back(v); }
+		T& push_back(T&& v) noexcept { return emplace_back(std::move(v)); }
+
+		template<typename F>
+		void remove_all(F f) noexcept {
+			size_t removed = 0;
+			for (size_t i = next_occupied(0); i < slots; i = next_occupied(i + 1)) {
+				auto x = slot(i);
+				if (!f(*x)) continue;
+
+				if constexpr (has_id<T>::value) pool_ids.erase(x->id);
+				x->~T();
+				set_occupied(i, false);
+				memcpy(x, &free_head, sizeof(size_t));
+				free_head = i;
+				removed++;
+			}
+			count -= removed;
+			PROFILER_COUNTER_ADD("pool removals", removed);
+		}
+
+		template<typename P>
+		struct Iterator {
+			P* pool = nullptr;
+			size_t i = 0;
+
+			auto& operator*() const noexcept { return *pool->slot(i); }
+			auto* operator->() const noexcept { return pool->slot(i); }
+			Iterator& operator++() noexcept {
+				i = pool->next_occupied(i + 1);
+				return *this;
+			}
+			bool operator==(const Iterator& other) const noexcept { return i == other.i; }
+			bool operator!=(const Iterator& other) const noexcept { return i != other.i; }
+		};
+
+		// end is read again at each step, what's pushed while iterating is visited if it
+		// lands after the current slot.
+		struct End {};
+		template<typename P>
+		friend bool operator!=(const Iterator<P>& it, End) noexcept {
+			return it.i < it.pool->slots;
+		}
+
+		Iterator<Stable_Pool> begin() noexcept { return { this, next_occupied(0) }; }
+		Iterator<const Stable_Pool> begin() const noexcept { return { this, next_occupied(0) }; }
+		End end() const noexcept { return {}; }
+
+		T& operator[](size_t i) noexcept { return *slot(i); }
+		const T& operator[](size_t i) const noexcept { return *slot(i); }
+
+		T& id(size_t id) noexcept { return *slot(pool_ids.at(id)); }
+		const T& id(size_t id) const noexcept { return *slot(pool_ids.at(id)); }
+
+		bool exist(size_t id) const noexcept { return pool_ids.contains(id); }
+
+		// Live elements.
+		size_t size() const noexcept { return count; }
+		size_t slot_count() const noexcept { return slots; }
+
+		bool occupied(size_t i) const noexcept {
+			return (blocks[i / Block_Size]->occupied[i % Block_Size / 64] >> (i % 64)) & 1;
+		}
+
+		// The first occupied slot from i on, slot_count() if there is none.
+		size_t next_occupied(size_t i) const noexcept {
+			while (i < slots) {
+				auto bits = blocks[i / Block_Size]->occupied[i % Block_Size / 64] >> (i % 64);
+				if (bits) return i + std::countr_zero(bits);
+				i = (i / 64 + 1) * 64;
+			}
+			return slots;
+		}
+
+		T* slot(size_t i) noexcept { return blocks[i / Block_Size]->at(i % Block_Size); }
+		const T* slot(size_t i) const noexcept {
+			return blocks[i / Block_Size]->at(i % Block_Size);
+		}
+
+		void set_occupied(size_t i, bool x) noexcept {
+			auto& word = blocks[i / Block_Size]->occupied[i % Block_Size / 64];
+			if (x) word |=  (std::uint64_t)1 << (i % 64);
+			else   word &= ~((std::uint64_t)1 << (i % 64));
+		}
+
+		template<typename, typename = void>
+		struct has_id : std::false_type {};
+
+		template<typename V>
+		struct has_id<V, std::void_t<decltype(&V::id)>> :
+			std::is_same<size_t, decltype(std::declval<V>().id)> {};
+	};
+};
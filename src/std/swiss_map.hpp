@@ -0,0 +1,369 @@
+#pragma once
+
+#include <bit>
+#include <initializer_list>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XSTD_SWISS_SSE2
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#define XSTD_SWISS_WASM
+#include <wasm_simd128.h>
+#endif
+
+#include "std/hash.hpp"
+#include "std/unordered_map.hpp"
+#include "Profiler/Counters.hpp"
+
+namespace xstd {
+
+	// Same interface as zedland::hashmap, different insides. Every slot has a control byte, 0x80
+	// when it's empty, else 7 bits of the hash of its key. A lookup compares 16 control bytes at
+	// a time with SSE2 (or WASM SIMD) and only looks at the keys whose 7 bits match, so most
+	// misses never touch a key.
+	// Probing is linear, slot by slot, and erase shifts back the keys that come after instead of
+	// leaving a tombstone: a key is always between its home slot and the first empty slot after
+	// it. The flip side is that erase can move other elements, don't erase while iterating.
+	// The hash is mixed again, xstd::hash<unsigned long> is the identity and pool ids, uuids
+	// and the like would otherwise all land next to each other.
+	namespace swiss {
+		constexpr uint8_t Empty = 0x80;
+		constexpr size_t Group_Size = 16;
+
+		// Bit i is set when the i-th of the 16 control bytes at ctrl is tag.
+		inline uint32_t match(const uint8_t* ctrl, uint8_t tag) noexcept {
+#if defined(XSTD_SWISS_SSE2)
+			auto group = _mm_loadu_si128((const __m128i*)ctrl);
+			return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)tag)));
+#elif defined(XSTD_SWISS_WASM)
+			auto group = wasm_v128_load(ctrl);
+			return (uint32_t)wasm_i8x16_bitmask(wasm_i8x16_eq(group, wasm_i8x16_splat(tag)));
+#else
+			uint32_t m = 0;
+			for (size_t i = 0; i < Group_Size; ++i) m |= (uint32_t)(ctrl[i] == tag) << i;
+			return m;
+#endif
+		}
+
+		inline uint32_t match_empty(const uint8_t* ctrl) noexcept {
+#if defined(XSTD_SWISS_SSE2)
+			return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+#elif defined(XSTD_SWISS_WASM)
+			return (uint32_t)wasm_i8x16_bitmask(wasm_v128_load(ctrl));
+#else
+			uint32_t m = 0;
+			for (size_t i = 0; i < Group_Size; ++i) m |= (uint32_t)(ctrl[i] >> 7) << i;
+			return m;
+#endif
+		}
+
+		inline uint64_t mix(uint64_t h) noexcept {
+			h *= 0x9e3779b97f4a7c15ull;
+			return h ^ (h >> 32);
+		}
+	};
+
+	template<
+		typename Key,
+		typename Value,
+		typename Hash = hash<Key>,
+		typename Pred = zedland::equal_to<Key>
+	>
+	struct swiss_map {
+		static constexpr size_t Group_Size = swiss::Group_Size;
+
+		static inline Hash _hasher;
+		static inline Pred _compare;
+
+		struct data_type {
+			Key first;
+			Value second;
+		};
+		using key_type = Key;
+		using mapped_type = Value;
+		using value_type = data_type;
+
+		size_t used = 0;
+		// 0 until the first insert, an empty map doesn't allocate.
+		size_t limit = 0;
+		// limit + Group_Size bytes, the Group_Size - 1 after limit repeat the first ones so a
+		// group starting near the end reads the start of the table.
+		uint8_t* ctrl = nullptr;
+		data_type* slots = nullptr;
+
+		template<bool Const>
+		struct basic_iterator {
+			using Map = std::conditional_t<Const, const swiss_map, swiss_map>;
+			using Data = std::conditional_t<Const, const data_type, data_type>;
+
+			Map* m;
+			size_t i;
+
+			basic_iterator(Map* m, size_t i) noexcept : m(m), i(step(m, i)) {}
+
+			static size_t step(Map* m, size_t i) noexcept {
+				while (i < m->limit && m->ctrl[i] == swiss::Empty) i++;
+				return i < m->limit ? i : m->limit;
+			}
+
+			basic_iterator& operator++() noexcept { i = step(m, i + 1); return *this; }
+			basic_iterator operator++(int) noexcept { auto r = *this; ++(*this); return r; }
+			Data& operator*() const noexcept { return m->slots[i]; }
+			Data* operator->() const noexcept { return &m->slots[i]; }
+			bool operator==(const basic_iterator& o) const noexcept {
+				return m == o.m && i == o.i;
+			}
+			bool operator!=(const basic_iterator& o) const noexcept { return !(*this == o); }
+		};
+		using iterator = basic_iterator<false>;
+		using const_iterator = basic_iterator<true>;
+
+		swiss_map() noexcept = default;
+		swiss_map(size_t n) noexcept { reserve(n); }
+		swiss_map(std::initializer_list<data_type> init) noexcept {
+			for (auto& x : init) insert(x);
+		}
+		~swiss_map() noexcept {
+			destroy_all();
+			free(ctrl);
+		}
+
+		swiss_map(const swiss_map& o) noexcept { copy(o); }
+		swiss_map(swiss_map&& o) noexcept :
+			used(o.used), limit(o.limit), ctrl(o.ctrl), slots(o.slots)
+		{
+			o.used = o.limit = 0;
+			o.ctrl = nullptr;
+			o.slots = nullptr;
+		}
+		swiss_map& operator=(const swiss_map& o) noexcept {
+			if (this == &o) return *this;
+			destroy_all();
+			free(ctrl);
+			copy(o);
+			return *this;
+		}
+		swiss_map& operator=(swiss_map&& o) noexcept {
+			if (this == &o) return *this;
+			destroy_all();
+			free(ctrl);
+			used = o.used;
+			limit = o.limit;
+			ctrl = o.ctrl;
+			slots = o.slots;
+			o.used = o.limit = 0;
+			o.ctrl = nullptr;
+			o.slots = nullptr;
+			return *this;
+		}
+
+		bool empty() const noexcept { return used == 0; }
+		size_t size() const noexcept { return used; }
+		size_t capacity() const noexcept { return limit; }
+
+		iterator begin() noexcept { return iterator(this, 0); }
+		iterator end() noexcept { return iterator(this, limit); }
+		const_iterator begin() const noexcept { return const_iterator(this, 0); }
+		const_iterator end() const noexcept { return const_iterator(this, limit); }
+
+		void reserve(size_t n) noexcept {
+			size_t l = limit ? limit : Group_Size;
+			while (n * 4 > l * 3) l *= 2;
+			if (l != limit) grow(l);
+		}
+
+		void clear() noexcept {
+			destroy_all();
+			if (ctrl) memset(ctrl, swiss::Empty, limit + Group_Size);
+			used = 0;
+		}
+
+		iterator insert(const data_type& v) noexcept {
+			uint64_t h = hash_of(v.first);
+			size_t i = find_index(v.first, h);
+			if (i != limit) slots[i].second = v.second;
+			else i = insert_new(h, v);
+			return iterator(this, i);
+		}
+		iterator insert(data_type&& v) noexcept {
+			uint64_t h = hash_of(v.first);
+			size_t i = find_index(v.first, h);
+			if (i != limit) slots[i].second = std::move(v.second);
+			else i = insert_new(h, std::move(v));
+			return iterator(this, i);
+		}
+		iterator insert(Key key, Value val) noexcept {
+			return insert(data_type{ std::move(key), std::move(val) });
+		}
+		iterator emplace(Key key, Value val) noexcept {
+			return insert(data_type{ std::move(key), std::move(val) });
+		}
+		iterator emplace(data_type v) noexcept { return insert(std::move(v)); }
+
+		Value& operator[](const Key& key) noexcept {
+			uint64_t h = hash_of(key);
+			size_t i = find_index(key, h);
+			if (i == limit) i = insert_new(h, data_type{ key, Value{} });
+			return slots[i].second;
+		}
+
+		iterator find(const Key& key) noexcept {
+			return iterator(this, find_index(key, hash_of(key)));
+		}
+		const_iterator find(const Key& key) const noexcept {
+			return const_iterator(this, find_index(key, hash_of(key)));
+		}
+		bool contains(const Key& key) const noexcept {
+			return find_index(key, hash_of(key)) != limit;
+		}
+		Value& at(const Key& key) noexcept { return slots[find_index(key, hash_of(key))].second; }
+		const Value& at(const Key& key) const noexcept {
+			return slots[find_index(key, hash_of(key))].second;
+		}
+
+		void erase(const Key& key) noexcept {
+			size_t hole = find_index(key, hash_of(key));
+			if (hole == limit) return;
+
+			slots[hole].~data_type();
+			used--;
+
+			// Everything up to the next empty slot that can move back to the hole does. It has
+			// to be rehashed to know its home, that's the price of not having tombstones.
+			size_t mask = limit - 1;
+			for (size_t j = (hole + 1) & mask; ctrl[j] != swiss::Empty; j = (j + 1) & mask) {
+				size_t home = home_of(hash_of(slots[j].first));
+				if (((j - home) & mask) < ((j - hole) & mask)) continue;
+
+				new (&slots[hole]) data_type(std::move(slots[j]));
+				slots[j].~data_type();
+				set_ctrl(hole, ctrl[j]);
+				hole = j;
+			}
+			set_ctrl(hole, swiss::Empty);
+		}
+
+	private:
+		static uint64_t hash_of(const Key& key) noexcept {
+			return swiss::mix((uint64_t)_hasher(key));
+		}
+		size_t home_of(uint64_t h) const noexcept { return (size_t)(h >> 7) & (limit - 1); }
+		static uint8_t tag_of(uint64_t h) noexcept { return (uint8_t)(h & 0x7f); }
+
+		void set_ctrl(size_t i, uint8_t c) noexcept {
+			ctrl[i] = c;
+			if (i < Group_Size - 1) ctrl[limit + i] = c;
+		}
+
+		// Index of the key, limit when it's not there.
+		size_t find_index(const Key& key, uint64_t h) const noexcept {
+			if (used == 0) return limit;
+
+			size_t mask = limit - 1;
+			size_t groups = 0;
+			for (size_t i = home_of(h); ; i = (i + Group_Size) & mask) {
+				groups++;
+				uint32_t empty = swiss::match_empty(ctrl + i);
+				// The key can't be past the first empty slot.
+				uint32_t before = empty ? (empty & (0 - empty)) - 1 : 0xffff;
+				for (uint32_t m = swiss::match(ctrl + i, tag_of(h)) & before; m; m &= m - 1) {
+					size_t j = (i + std::countr_zero(m)) & mask;
+					if (!_compare(slots[j].first, key)) continue;
+					count_groups(groups);
+					return j;
+				}
+				if (empty) break;
+			}
+			count_groups(groups);
+			return limit;
+		}
+
+		// Only the lookups that needed more than one group are counted, the others are one load
+		// and counting all of them would cost as much as the lookup itself.
+		static void count_groups(size_t groups) noexcept {
+			if (groups > 1) PROFILER_COUNTER_ADD("swiss map long probes", 1);
+		}
+
+		size_t find_empty(uint64_t h) const noexcept {
+			size_t mask = limit - 1;
+			for (size_t i = home_of(h); ; i = (i + Group_Size) & mask) {
+				if (auto e = swiss::match_empty(ctrl + i)) return (i + std::countr_zero(e)) & mask;
+			}
+		}
+
+		// The key isn't in the map yet. Keeps the load under 3/4, past that the runs of full
+		// slots get long.
+		template<typename D>
+		size_t insert_new(uint64_t h, D&& v) noexcept {
+			if ((used + 1) * 4 > limit * 3) grow(limit ? limit * 2 : Group_Size);
+
+			size_t i = find_empty(h);
+			new (&slots[i]) data_type(std::forward<D>(v));
+			set_ctrl(i, tag_of(h));
+			used++;
+			return i;
+		}
+
+		static size_t ctrl_bytes(size_t n) noexcept {
+			size_t align = alignof(data_type);
+			return (n + Group_Size + align - 1) / align * align;
+		}
+
+		void allocate(size_t n) noexcept {
+			limit = n;
+			ctrl = (uint8_t*)malloc(ctrl_bytes(n) + n * sizeof(data_type));
+			slots = (data_type*)(ctrl + ctrl_bytes(n));
+			memset(ctrl, swiss::Empty, n + Group_Size);
+		}
+
+		void grow(size_t n) noexcept {
+			auto old_ctrl = ctrl;
+			auto old_slots = slots;
+			auto old_limit = limit;
+
+			allocate(n);
+			for (size_t i = 0; i < old_limit; ++i) {
+				if (old_ctrl[i] == swiss::Empty) continue;
+				uint64_t h = hash_of(old_slots[i].first);
+				size_t j = find_empty(h);
+				new (&slots[j]) data_type(std::move(old_slots[i]));
+				old_slots[i].~data_type();
+				set_ctrl(j, tag_of(h));
+			}
+			free(old_ctrl);
+		}
+
+		void copy(const swiss_map& o) noexcept {
+			used = 0;
+			limit = 0;
+			ctrl = nullptr;
+			slots = nullptr;
+			if (!o.limit) return;
+
+			allocate(o.limit);
+			used = o.used;
+			memcpy(ctrl, o.ctrl, limit + Group_Size);
+			if constexpr (std::is_trivially_copyable_v<data_type>) {
+				memcpy(slots, o.slots, limit * sizeof(data_type));
+			} else {
+				for (size_t i = 0; i < limit; ++i) {
+					if (ctrl[i] != swiss::Empty) new (&slots[i]) data_type(o.slots[i]);
+				}
+			}
+		}
+
+		void destroy_all() noexcept {
+			if constexpr (!std::is_trivially_destructible_v<data_type>) {
+				for (size_t i = 0; i < limit; ++i) {
+					if (ctrl[i] != swiss::Empty) slots[i].~data_type();
+				}
+			}
+		}
+	};
+};
@@ -23,6 +23,7 @@
 #include <cstdlib>
 #include <cstddef>
 #include <cassert>
+#include <type_traits>
 
 #include "std/hash.hpp"
 #include "type_traits.hpp"
@@ -39,6 +40,18 @@ namespace zedland {
  * tombstone bitmap, which are allocated in a single call to malloc.
  */
 
+#ifdef PROFILER
+/*
+ * lookups and the slots they looked at on this thread. plain adds, snapshot_counters in
+ * Profiler/Counters.cpp turns them into the hashmap counters once a frame.
+ */
+struct probe_stats {
+    size_t lookups;
+    size_t probes;
+};
+inline thread_local probe_stats hashmap_probe_stats = {};
+#endif
+
 template<typename T>
 struct equal_to {
     constexpr bool operator()(const T& x, const T& y) const noexcept {
@@ -135,7 +148,7 @@ struct hashmap
         used(0), tombs(0), limit(initial_size)
     {
         size_t data_size = sizeof(data_type) * limit;
-        size_t bitmap_size = limit >> 2;
+        size_t bitmap_size = bitmap_bytes(limit);
         size_t total_size = data_size + bitmap_size;
 
         assert(is_pow2(limit));
@@ -144,7 +157,22 @@ struct hashmap
         bitmap = (uint64_t*)((char*)data + data_size);
         memset(data, 0, total_size);
     }
-    inline ~hashmap() { free(data); }
+    inline ~hashmap() { destroy_slots(); free(data); }
+
+    /*
+     * keys and values are placement new'd in, the ones that aren't trivially destructible
+     * (std::string, dyn_struct) are destroyed here before their slots are freed or forgotten.
+     */
+    inline void destroy_slots()
+    {
+        if constexpr (!std::is_trivially_destructible_v<data_type>) {
+            if (!data) return;
+            for (size_t i = 0; i < limit; ++i) {
+                if ((bitmap_get(bitmap, i) & occupied) != occupied) continue;
+                data[i].~data_type();
+            }
+        }
+    }
 
     /*
      * copy constructor and assignment operator
@@ -154,12 +182,33 @@ struct hashmap
         used(o.used), tombs(o.tombs), limit(o.limit)
     {
         size_t data_size = sizeof(data_type) * limit;
-        size_t bitmap_size = limit >> 2;
+        size_t bitmap_size = bitmap_bytes(limit);
         size_t total_size = data_size + bitmap_size;
 
         data = (data_type*)malloc(total_size);
         bitmap = (uint64_t*)((char*)data + data_size);
-        memcpy(data, o.data, total_size);
+        copy_slots(o);
+    }
+
+    /*
+     * keys and values that can't be memcpy'd (std::string, ValuePtr) are copy constructed in
+     * place, a byte copy would alias their heap buffers or self pointers.
+     */
+    inline void copy_slots(const hashmap &o)
+    {
+        size_t data_size = sizeof(data_type) * limit;
+        size_t bitmap_size = bitmap_bytes(limit);
+
+        if constexpr (std::is_trivially_copyable_v<data_type>) {
+            memcpy(data, o.data, data_size + bitmap_size);
+        } else {
+            memset(data, 0, data_size);
+            memcpy(bitmap, o.bitmap, bitmap_size);
+            for (size_t i = 0; i < limit; ++i) {
+                if ((bitmap_get(bitmap, i) & occupied) != occupied) continue;
+                new (&data[i]) data_type(o.data[i]);
+            }
+        }
     }
 
     inline hashmap(hashmap &&o) :
@@ -176,6 +225,8 @@ struct hashmap
 
     inline hashmap& operator=(const hashmap &o)
     {
+        if (this == &o) return *this;
+        destroy_slots();
         free(data);
 
         used = o.used;
@@ -183,18 +234,22 @@ struct hashmap
         limit = o.limit;
 
         size_t data_size = sizeof(data_type) * limit;
-        size_t bitmap_size = limit >> 2;
+        size_t bitmap_size = bitmap_bytes(limit);
         size_t total_size = data_size + bitmap_size;
 
         data = (data_type*)malloc(total_size);
         bitmap = (uint64_t*)((char*)data + data_size);
-        memcpy(data, o.data, total_size);
+        copy_slots(o);
 
         return *this;
     }
 
     inline hashmap& operator=(hashmap &&o)
     {
+        if (this == &o) return *this;
+        destroy_slots();
+        free(data);
+
         data = o.data;
         bitmap = o.bitmap;
         used = o.used;
@@ -231,6 +286,8 @@ struct hashmap
     enum bitmap_state {
         available = 0, occupied = 1, deleted = 2, recycled = 3
     };
+    /* 2 bits a slot, in whole words: below 32 slots limit >> 2 bytes was less than one. */
+    static inline size_t bitmap_bytes(size_t n) { return ((n + 31) >> 5) * sizeof(uint64_t); }
     static inline size_t bitmap_idx(size_t i) { return i >> 5; }
     static inline size_t bitmap_shift(size_t i) { return ((i << 1) & 63); }
     static inline bitmap_state bitmap_get(uint64_t *bitmap, size_t i)
@@ -259,7 +316,7 @@ struct hashmap
                          size_t old_size, size_t new_size)
     {
         size_t data_size = sizeof(data_type) * new_size;
-        size_t bitmap_size = new_size >> 2;
+        size_t bitmap_size = bitmap_bytes(new_size);
         size_t total_size = data_size + bitmap_size;
 
         assert(is_pow2(new_size));
@@ -275,7 +332,8 @@ struct hashmap
             for (size_t j = key_index(v->first); ; j = (j+1) & index_mask()) {
                 if ((bitmap_get(bitmap, j) & occupied) != occupied) {
                     bitmap_set(bitmap, j, occupied);
-                    data[j] = std::move(*v);
+                    new (&data[j]) data_type(std::move(*v));
+                    v->~data_type();
                     break;
                 }
             }
@@ -288,8 +346,9 @@ struct hashmap
     void clear()
     {
         size_t data_size = sizeof(data_type) * limit;
-        size_t bitmap_size = limit >> 2;
+        size_t bitmap_size = bitmap_bytes(limit);
         size_t total_size = data_size + bitmap_size;
+        destroy_slots();
         memset(data, 0, total_size);
         used = tombs = 0;
     }
@@ -304,111 +363,123 @@ struct hashmap
     iterator emplace(value_type v) {
         return insert(std::move(v));
     }
-    iterator insert(const value_type& v)
+
+    /*
+     * index of key if it's there, otherwise of the first slot it can go in. we can't stop at
+     * the first tombstone, the key might still be further down the probe sequence.
+     */
+    size_t find_slot(const Key &key, bool &found) const
     {
-        for (size_t i = key_index(v.first); ; i = (i+1) & index_mask()) {
+        size_t slot = limit;
+        size_t home = key_index(key);
+        for (size_t i = home; ; i = (i+1) & index_mask()) {
             bitmap_state state = bitmap_get(bitmap, i);
+            if (state == available) {
+                count_probes(home, i);
+                found = false;
+                return slot == limit ? i : slot;
+            }
             if ((state & occupied) != occupied) {
-                bitmap_set(bitmap, i, occupied);
-                data[i] = v;
-                used++;
-                if ((state & deleted) == deleted) tombs--;
-                if (load() > load_factor) {
-                    resize_internal(data, bitmap, limit, limit << 1);
-                    for (i = key_index(v.first); ; i = (i+1) & index_mask()) {
-                        bitmap_state state = bitmap_get(bitmap, i);
-                             if (state == available) abort();
-                        else if (state == deleted); /* skip */
-                        else if (_compare(data[i].first, v.first)) {
-                            return iterator(this, i);
-                        }
-                    }
-                } else {
-                    return iterator(this, i);
-                }
-            } else if (_compare(data[i].first, v.first)) {
-                data[i].second = v.second;
-                return iterator(this, i);
+                if (slot == limit) slot = i;
+            } else if (_compare(data[i].first, key)) {
+                count_probes(home, i);
+                found = true;
+                return i;
             }
         }
     }
+
+    /* probes/lookups is the mean probe length. */
+    void count_probes(size_t home, size_t last) const
+    {
+#ifdef PROFILER
+        hashmap_probe_stats.lookups++;
+        hashmap_probe_stats.probes += ((last - home) & index_mask()) + 1;
+#endif
+    }
+
+    iterator insert(const value_type& v)
+    {
+        bool found;
+        size_t i = find_slot(v.first, found);
+        if (found) {
+            data[i].second = v.second;
+            return iterator(this, i);
+        }
+
+        bitmap_state state = bitmap_get(bitmap, i);
+        bitmap_set(bitmap, i, occupied);
+        new (&data[i]) value_type(v);
+        used++;
+        if ((state & deleted) == deleted) tombs--;
+        if (load() > load_factor) {
+            resize_internal(data, bitmap, limit, limit << 1);
+            i = find_slot(v.first, found);
+        }
+        return iterator(this, i);
+    }
     iterator insert(value_type&& v)
     {
-        for (size_t i = key_index(v.first); ; i = (i+1) & index_mask()) {
-            bitmap_state state = bitmap_get(bitmap, i);
-            if ((state & occupied) != occupied) {
-                bitmap_set(bitmap, i, occupied);
-                auto old_key = v.first;
-                data[i] = std::move(v);
-                used++;
-                if ((state & deleted) == deleted) tombs--;
-                if (load() > load_factor) {
-                    resize_internal(data, bitmap, limit, limit << 1);
-                    for (i = key_index(old_key); ; i = (i+1) & index_mask()) {
-                        bitmap_state state = bitmap_get(bitmap, i);
-                             if (state == available) abort();
-                        else if (state == deleted); /* skip */
-                        else if (_compare(data[i].first, old_key)) {
-                            return iterator(this, i);
-                        }
-                    }
-                } else {
-                    return iterator(this, i);
-                }
-            } else if (_compare(data[i].first, v.first)) {
-                data[i].second = std::move(v.second);
-                return iterator(this, i);
-            }
+        bool found;
+        size_t i = find_slot(v.first, found);
+        if (found) {
+            data[i].second = std::move(v.second);
+            return iterator(this, i);
+        }
+
+        bitmap_state state = bitmap_get(bitmap, i);
+        bitmap_set(bitmap, i, occupied);
+        auto old_key = v.first;
+        new (&data[i]) value_type(std::move(v));
+        used++;
+        if ((state & deleted) == deleted) tombs--;
+        if (load() > load_factor) {
+            resize_internal(data, bitmap, limit, limit << 1);
+            i = find_slot(old_key, found);
         }
+        return iterator(this, i);
     }
 
     Value& operator[](Key key)
     {
-        for (size_t i = key_index(key); ; i = (i+1) & index_mask()) {
-            bitmap_state state = bitmap_get(bitmap, i);
-            if ((state & occupied) != occupied) {
-                used++;
-                if ((state & deleted) == deleted) tombs--;
-                bitmap_set(bitmap, i, occupied);
-
-                new (&data[i]) value_type;
-                data[i].first = key;
-
-                if (load() > load_factor) {
-                    resize_internal(data, bitmap, limit, limit << 1);
-                    for (i = key_index(key);; i = (i+1) & index_mask()) {
-                        bitmap_state state = bitmap_get(bitmap, i);
-                             if (state == available) abort();
-                        else if (state == deleted); /* skip */
-                        else if (_compare(data[i].first, key)) {
-                            return data[i].second;
-                        }
-                    }
-                }
-                return data[i].second;
-            } else if (_compare(data[i].first, key)) {
-                return data[i].second;
-            }
+        bool found;
+        size_t i = find_slot(key, found);
+        if (found) return data[i].second;
+
+        bitmap_state state = bitmap_get(bitmap, i);
+        used++;
+        if ((state & deleted) == deleted) tombs--;
+        bitmap_set(bitmap, i, occupied);
+
+        new (&data[i]) value_type;
+        data[i].first = key;
+
+        if (load() > load_factor) {
+            resize_internal(data, bitmap, limit, limit << 1);
+            i = find_slot(key, found);
         }
+        return data[i].second;
     }
 
     iterator find(const Key &key)
     {
-        for (size_t i = key_index(key); ; i = (i+1) & index_mask()) {
+        size_t home = key_index(key);
+        for (size_t i = home; ; i = (i+1) & index_mask()) {
             bitmap_state state = bitmap_get(bitmap, i);
-                 if (state == available)           /* notfound */ break;
+                 if (state == available)           /* notfound */ { count_probes(home, i); break; }
             else if (state == deleted);            /* skip */
-            else if (_compare(data[i].first, key)) return iterator(this, i);
+            else if (_compare(data[i].first, key)) { count_probes(home, i); return iterator(this, i); }
         }
         return end();
     }
     iterator find(const Key &key) const
     {
-        for (size_t i = key_index(key); ; i = (i+1) & index_mask()) {
+        size_t home = key_index(key);
+        for (size_t i = home; ; i = (i+1) & index_mask()) {
             bitmap_state state = bitmap_get(bitmap, i);
-                 if (state == available)           /* notfound */ break;
+                 if (state == available)           /* notfound */ { count_probes(home, i); break; }
             else if (state == deleted);            /* skip */
-            else if (_compare(data[i].first, key)) return iterator(this, i);
+            else if (_compare(data[i].first, key)) { count_probes(home, i); return iterator(this, i); }
         }
         return end();
     }
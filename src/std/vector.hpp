@@ -1,5 +1,9 @@
 #pragma once
 
+#include <new>
+#include <string.h>
+#include <type_traits>
+
 #include "int.hpp"
 #include "type_traits.hpp"
 
@@ -7,11 +11,67 @@ namespace xstd {
 
 	#define move(x) (static_cast<remove_reference_t<decltype(x)>&&>(x))
 
+	#ifdef _MSC_VER
+	#define XSTD_NOINLINE __declspec(noinline)
+	#else
+	#define XSTD_NOINLINE __attribute__((noinline))
+	#endif
+
 	static void assert_(bool cond) {
 		if (!cond) throw "oops";
 	}
 
+	// Types that can be moved to another address with a memcpy and without calling the
+	// destructor of the old one: no pointer into themselves, nothing that remembers where it
+	// lives. Everything trivially copyable is, other types opt in with
+	// XSTD_TRIVIALLY_RELOCATABLE, then vector grows them with a memcpy.
 	template<typename T>
+	struct is_trivially_relocatable {
+		static constexpr bool value = std::is_trivially_copyable_v<T>;
+	};
+	template<typename T>
+	constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+	#define XSTD_TRIVIALLY_RELOCATABLE(...)\
+		template<> struct xstd::is_trivially_relocatable<__VA_ARGS__> {\
+			static constexpr bool value = true;\
+		}
+
+	// How much a vector grows when it's full and needed more. The old 10 + 1.5x is the default.
+	struct Growth_1_5 {
+		static constexpr size_t next(size_t capacity, size_t needed) noexcept {
+			size_t n = (size_t)(10 + capacity * 1.5);
+			return n < needed ? needed : n;
+		}
+	};
+	struct Growth_Double {
+		static constexpr size_t next(size_t capacity, size_t needed) noexcept {
+			size_t n = capacity ? capacity * 2 : 16;
+			return n < needed ? needed : n;
+		}
+	};
+
+	// Where a vector gets its storage from. Anything with the same two functions works, see
+	// Frame_Allocator in std/arena.hpp.
+	struct Heap_Allocator {
+		static void* allocate(size_t n, size_t align) noexcept {
+			if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+				return ::operator new(n, std::align_val_t(align));
+			}
+			return ::operator new(n);
+		}
+		static void deallocate(void* p, size_t align) noexcept {
+			if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+				::operator delete(p, std::align_val_t(align));
+			} else {
+				::operator delete(p);
+			}
+		}
+	};
+
+	// Storage is left uninitialized past size(), elements are constructed in place when they
+	// are added and destroyed when they are removed. clear keeps the capacity.
+	template<typename T, typename Growth = Growth_1_5, typename Alloc = Heap_Allocator>
 	struct vector {
 		using Stored_t = T;
 
@@ -20,18 +80,35 @@ namespace xstd {
 		size_t capacity = 0;
 
 		vector() noexcept {}
-		~vector() noexcept { delete[] data_; size_ = 0; capacity = 0; };
+		~vector() noexcept {
+			destroy(0, size_);
+			deallocate(data_);
+			size_ = 0;
+			capacity = 0;
+		};
+
+		vector(const vector& other) noexcept { *this = other; }
+		vector& operator=(const vector& other) noexcept {
+			if (this == &other) return *this;
 
-		vector(const vector<T>& other) noexcept { *this = other; }
-		vector& operator=(const vector<T>& other) noexcept {
+			clear();
 			reserve(other.size());
-			for (size_t i = 0; i < other.size(); ++i) data_[i] = other[i];
+			if constexpr (std::is_trivially_copyable_v<T>) {
+				if (other.size_) memcpy((void*)data_, other.data_, other.size_ * sizeof(T));
+			} else {
+				for (size_t i = 0; i < other.size(); ++i) new (data_ + i) T(other[i]);
+			}
 			size_ = other.size();
 			return *this;
 		}
 
-		vector(vector<T>&& other) noexcept { *this = move(other); }
-		vector& operator=(vector<T>&& other) noexcept {
+		vector(vector&& other) noexcept { *this = move(other); }
+		vector& operator=(vector&& other) noexcept {
+			if (this == &other) return *this;
+
+			destroy(0, size_);
+			deallocate(data_);
+
 			data_ = other.data_;
 			size_ = other.size_;
 			capacity = other.capacity;
@@ -41,26 +118,36 @@ namespace xstd {
 			return *this;
 		}
 
-		void push_back(T t) noexcept {
-			if (size_ + 1 > capacity) reserve((size_t)(10 + capacity * 1.5));
-
-			data_[size_++] = move(t);
+		void push_back(const T& t) noexcept { emplace_back(t); }
+		void push_back(T&& t) noexcept { emplace_back(move(t)); }
+
+		// Growing stays out of line so the rest inlines at every push_back, it didn't and each
+		// one was a call. size_ is read once and written before the construction, a T stored
+		// through data_ may alias it (it does for size_t).
+		template<typename... Args>
+		T& emplace_back(Args&&... args) noexcept {
+			size_t s = size_;
+			if (s < capacity) {
+				T* p = data_ + s;
+				size_ = s + 1;
+				return *new (p) T(static_cast<Args&&>(args)...);
+			}
+			return grow_emplace_back(static_cast<Args&&>(args)...);
 		}
 
-		constexpr void pop_back() noexcept { size_--; }
+		void pop_back() noexcept { data_[--size_].~T(); }
 
 		void reserve(size_t n) noexcept {
 			if (n <= capacity) return;
 
-			auto new_data = new T[n];
-			for (size_t i = 0; i < size_; ++i) new_data[i] = move(data_[i]);
-			if (data_) delete[] data_;
-			data_ = new_data;
-
+			relocate(allocate(n));
 			capacity = n;
 		}
 
-		constexpr void clear() noexcept { size_ = 0; }
+		void clear() noexcept {
+			destroy(0, size_);
+			size_ = 0;
+		}
 
 		constexpr T& operator[](size_t idx) noexcept {
 			#ifdef _DEBUG
@@ -78,17 +165,30 @@ namespace xstd {
 		constexpr T* data() noexcept { return data_; }
 		constexpr const T* data() const noexcept { return data_; }
 
-		void resize(size_t n, const T& v = {}) noexcept {
+		void resize(size_t n) noexcept {
+			if (n < size_) return shrink(n);
 			reserve(n);
-
-			for (; size_ < n; ++size_) data_[size_] = v;
-			size_ = n;
+			for (; size_ < n; ++size_) new (data_ + size_) T();
+		}
+		void resize(size_t n, const T& v) noexcept {
+			if (n < size_) return shrink(n);
+			if (n > capacity) {
+				// v might be in there.
+				T copy = v;
+				reserve(n);
+				for (; size_ < n; ++size_) new (data_ + size_) T(copy);
+				return;
+			}
+			for (; size_ < n; ++size_) new (data_ + size_) T(v);
 		}
 
 		template<typename F>
 		void erase(const F& f) noexcept {
-			for (size_t i = 0; i < size_; ++i) if (f(data_[i]))
-				data_[i--] = data_[--size_];
+			for (size_t i = 0; i < size_; ++i) if (f(data_[i])) {
+				if (i + 1 != size_) data_[i] = move(data_[size_ - 1]);
+				pop_back();
+				--i;
+			}
 		}
 
 		T& back() noexcept { return data_[size_ - 1]; };
@@ -104,6 +204,70 @@ namespace xstd {
 
 		constexpr bool empty() const noexcept { return size_ == 0; }
 		constexpr bool used() const noexcept { return size_ > 0; }
+
+	private:
+		// The new element is constructed before the old ones move, it can be made from one of
+		// them.
+		template<typename... Args>
+		XSTD_NOINLINE T& grow_emplace_back(Args&&... args) noexcept {
+			size_t s = size_;
+			size_t n = Growth::next(capacity, s + 1);
+			T* new_data = allocate(n);
+			T* p = new (new_data + s) T(static_cast<Args&&>(args)...);
+			relocate(new_data);
+			capacity = n;
+			size_ = s + 1;
+			return *p;
+		}
+
+		static T* allocate(size_t n) noexcept {
+			return (T*)Alloc::allocate(n * sizeof(T), alignof(T));
+		}
+		static void deallocate(T* p) noexcept {
+			if (p) Alloc::deallocate((void*)p, alignof(T));
+		}
+
+		void destroy(size_t from, size_t to) noexcept {
+			if constexpr (!std::is_trivially_destructible_v<T>) {
+				for (size_t i = from; i < to; ++i) data_[i].~T();
+			}
+		}
+
+		void shrink(size_t n) noexcept {
+			destroy(n, size_);
+			size_ = n;
+		}
+
+		// Moves the size_ elements to new_data and frees the old storage.
+		void relocate(T* new_data) noexcept {
+			if constexpr (is_trivially_relocatable_v<T>) {
+				if (size_) memcpy((void*)new_data, (const void*)data_, size_ * sizeof(T));
+			} else {
+				for (size_t i = 0; i < size_; ++i) {
+					new (new_data + i) T(move(data_[i]));
+					data_[i].~T();
+				}
+			}
+			deallocate(data_);
+			data_ = new_data;
+		}
+	};
+
+	template<typename T, typename G, typename A, typename F>
+	void remove_all(xstd::vector<T, G, A>& vec, F&& f) noexcept {
+		size_t s = vec.size_;
+		for (size_t i = 0; i < s; ++i) if (f(vec[i])) {
+			if (i + 1 != s) vec[i] = move(vec[s - 1]);
+			--s;
+			--i;
+		}
+		vec.resize(s);
+	}
+
+	// Only ever points outside of itself.
+	template<typename T, typename G, typename A>
+	struct is_trivially_relocatable<vector<T, G, A>> {
+		static constexpr bool value = true;
 	};
 
 	template<typename T, size_t D_>
@@ -226,7 +390,8 @@ namespace xstd {
 			data = small_vec.data();
 			size = small_vec.size;
 		}
-		span(xstd::vector<T>& vec) noexcept {
+		template<typename G, typename A>
+		span(xstd::vector<T, G, A>& vec) noexcept {
 			data = vec.data();
 			size = vec.size();
 		}
@@ -261,16 +426,6 @@ namespace xstd {
 		}
 		vec.size = s;
 	}
-	template<typename T, typename F>
-	void remove_all(xstd::vector<T>& vec, F&& f) noexcept {
-		size_t s = vec.size_;
-		for (size_t i = 0; i < s; ++i) if (f(vec[i])) {
-			vec[i] = vec[s - 1];
-			--s;
-			--i;
-		}
-		vec.size_ = s;
-	}
 	template<typename T, size_t D, typename F>
 	void remove_all(xstd::small_vector<T, D>& vec, F&& f) noexcept {
 		size_t s = vec.size;
@@ -286,13 +441,19 @@ namespace xstd {
 };
 
 namespace std {
-	template<typename T> T* begin(xstd::vector<T>& v) noexcept { return v.data_; }
-	template<typename T> T* end  (xstd::vector<T>& v) noexcept { return v.data_ + v.size_; }
+	template<typename T, typename G, typename A>
+	T* begin(xstd::vector<T, G, A>& v) noexcept { return v.data_; }
+	template<typename T, typename G, typename A>
+	T* end  (xstd::vector<T, G, A>& v) noexcept {
+		return v.data_ + v.size_;
+	}
 	
-	template<typename T> const T* cbegin(const xstd::vector<T>& v) noexcept {
+	template<typename T, typename G, typename A>
+	const T* cbegin(const xstd::vector<T, G, A>& v) noexcept {
 		return v.data_;
 	}
-	template<typename T> const T* cend  (const xstd::vector<T>& v) noexcept {
+	template<typename T, typename G, typename A>
+	const T* cend  (const xstd::vector<T, G, A>& v) noexcept {
 		return v.data_ + v.size_;
 	}
 	template<typename T> T* begin(xstd::span<T>& v) noexcept { return v.data; }
@@ -5,9 +5,15 @@
 #include <string>
 #include <atomic>
 
+#include "std/arena.hpp"
 #include "std/vector.hpp"
 #include "std/unordered_map.hpp"
+#include "std/swiss_map.hpp"
+#include "std/stable_pool.hpp"
+#include "std/side_pool.hpp"
+#include "std/interned.hpp"
 #include "std/hash.hpp"
+#include "Profiler/Counters.hpp"
 
 
 namespace details {
@@ -47,110 +53,161 @@ template<bool flag = false> void static_no_match() noexcept {
 
 #define sum_type_X_Kind(x) , x##_Kind
 #define sum_type_X_Union(x) x x##_;
+#define sum_type_X_Union_boxed(x) xstd::Boxed<x> x##_;
+#define sum_type_X_count(x) + 1
+#define sum_type_X_size(x) , sizeof(x)
+#define sum_type_X_str(x) , #x
+#define sum_type_X_trivial(x) , std::is_trivially_copyable_v<x>
+#define sum_type_X_trivial_boxed(x) , false
 #define sum_type_X_cst(x) else if constexpr (std::is_same_v<T, x>) {\
-	kind = x##_Kind; new (&x##_) x; x##_ = (y);\
+	kind = x##_Kind; new (&x##_) decltype(x##_)(y);\
 }
-#define sum_type_X_case_cst_kind(x) case x##_Kind: new(&x##_) x; break;
-#define sum_type_X_case_cpy(x) case x##_Kind: new(&x##_) x; x##_ = that.x##_; break;
-#define sum_type_X_case_mve(x) case x##_Kind: new(&x##_) x; x##_ = std::move(that.x##_); break;
-#define sum_type_X_dst(x) case x##_Kind: x##_ .x::~x (); break;
-#define sum_type_X_name(x) case x##_Kind: return #x;
+#define sum_type_X_case_cst_kind(x) case x##_Kind: new(&x##_) decltype(x##_); break;
+// The bytes were memcpy'd already, that's the whole copy for what is trivially copyable.
+#define sum_type_X_case_cpy(x) case x##_Kind:\
+	if constexpr (!std::is_trivially_copyable_v<decltype(x##_)>)\
+		new(&x##_) decltype(x##_)(that.x##_);\
+	break;
+#define sum_type_X_case_mve(x) case x##_Kind:\
+	if constexpr (!std::is_trivially_copyable_v<decltype(x##_)>)\
+		new(&x##_) decltype(x##_)(std::move(that.x##_));\
+	break;
+#define sum_type_X_dst(x) case x##_Kind:\
+	if constexpr (!std::is_trivially_destructible_v<decltype(x##_)>) {\
+		using T_ = decltype(x##_);\
+		x##_.~T_();\
+	}\
+	break;
 #define sum_type_X_cast(x) if constexpr (std::is_same_v<T, x>) { return x##_; }
+#define sum_type_X_cast_boxed(x) if constexpr (std::is_same_v<T, x>) { return *x##_; }
 #define sum_type_X_one_of(x) std::is_same_v<T, x> ||
+// Partial specializations, gcc doesn't take explicit ones at class scope, hence the D_.
 #define sum_type_X_map_kind_to_type(x)\
-	template<> struct MAP_kind_type<x##_Kind> { using type = x; };
+	template<typename D_> struct MAP_kind_type<x##_Kind, D_> { using type = x; };
 #define sum_type_X_map_type_to_kind(x)\
-	template<> struct MAP_type_kind<x> { static constexpr auto kind = x##_Kind; };
+	template<typename D_> struct MAP_type_kind<x, D_> { static constexpr auto kind = x##_Kind; };
+
+#define sum_type_no_list(X)
 
 #pragma clang diagnostic ignored "-Wdynamic-class-memaccess"
 
-#define sum_type(n, list)\
-		union { list(sum_type_X_Union) };\
-		enum Kind { None_Kind = 0 list(sum_type_X_Kind), Count } kind;\
-		template<typename T>\
+#define sum_type(n, list) sum_type_boxed(n, list, sum_type_no_list)
+
+// The kinds of boxed are kept out of line in their xstd::Side_Pool, only a pointer to them is in
+// the union: for the big kinds that are rare enough that the others shouldn't pay for their
+// size. Kind_Size, Kind_Boxed and Kind_Trivial tell what each kind costs at compile time,
+// --sizes of the headless build prints them.
+// Copies and moves memcpy the whole thing and only construct the kind in place again when it
+// isn't trivially copyable.
+#define sum_type_boxed(n, list, boxed)\
+		union { list(sum_type_X_Union) boxed(sum_type_X_Union_boxed) };\
+		enum Kind { None_Kind = 0 list(sum_type_X_Kind) boxed(sum_type_X_Kind), Count } kind;\
+		static constexpr size_t Inline_Count = 0 list(sum_type_X_count);\
+		static constexpr size_t Kind_Size[Count] = {\
+			0 list(sum_type_X_size) boxed(sum_type_X_size)\
+		};\
+		static constexpr const char* Kind_Name[Count] = {\
+			"??" list(sum_type_X_str) boxed(sum_type_X_str)\
+		};\
+		static constexpr bool Kind_Trivial[Count] = {\
+			true list(sum_type_X_trivial) boxed(sum_type_X_trivial_boxed)\
+		};\
+		static constexpr bool Kind_Boxed(Kind k) noexcept { return k > Inline_Count; }\
+		template<typename T, typename D_ = void>\
 		struct MAP_type_kind {};\
 		list(sum_type_X_map_type_to_kind)\
-		template<Kind k>\
+		boxed(sum_type_X_map_type_to_kind)\
+		template<Kind k, typename D_ = void>\
 		struct MAP_kind_type {};\
 		list(sum_type_X_map_kind_to_type)\
+		boxed(sum_type_X_map_kind_to_type)\
 		n() noexcept { kind = None_Kind; }\
 		explicit n(Kind k) noexcept {\
 			kind = k;\
 			switch(kind) {\
-				list(sum_type_X_case_cst_kind);\
+				list(sum_type_X_case_cst_kind)\
+				boxed(sum_type_X_case_cst_kind)\
 				default: break;\
 			}\
 		}\
 		template<typename T> n(const T& y) noexcept {\
 			if constexpr (false);\
 			list(sum_type_X_cst)\
-			else static_no_match<list(sum_type_X_one_of) false>();\
-		}\
-		~n() {\
-			switch(kind) {\
-				list(sum_type_X_dst)\
-				default: break;\
-			}\
+			boxed(sum_type_X_cst)\
+			else static_no_match<list(sum_type_X_one_of) boxed(sum_type_X_one_of) false>();\
 		}\
+		~n() { destroy_kind(); }\
 		n(std::nullptr_t) noexcept { kind = None_Kind; }\
 		n(n&& that) noexcept {\
 			memcpy(this, &that, sizeof(that));\
-			kind = that.kind;\
-			switch (kind) {\
-				list(sum_type_X_case_mve)\
-				default: break;\
-			}\
+			move_kind(that);\
 		}\
 		n(const n& that) noexcept {\
 			memcpy(this, &that, sizeof(that));\
-			kind = that.kind;\
-			switch (kind) {\
-				list(sum_type_X_case_cpy)\
-				default: break;\
-			}\
+			copy_kind(that);\
 		}\
 		n& operator=(const n& that) noexcept {\
+			if (this == &that) return *this;\
+			destroy_kind();\
 			memcpy(this, &that, sizeof(that));\
-			kind = that.kind;\
+			copy_kind(that);\
+			return *this;\
+		}\
+		n& operator=(n&& that) noexcept {\
+			if (this == &that) return *this;\
+			destroy_kind();\
+			memcpy(this, &that, sizeof(that));\
+			move_kind(that);\
+			return *this;\
+		}\
+		void copy_kind(const n& that) noexcept {\
 			switch (kind) {\
 				list(sum_type_X_case_cpy)\
+				boxed(sum_type_X_case_cpy)\
 				default: break;\
 			}\
-			return *this;\
 		}\
-		n& operator=(n&& that) noexcept {\
-			memcpy(this, &that, sizeof(that));\
-			kind = that.kind;\
+		void move_kind(n& that) noexcept {\
 			switch (kind) {\
 				list(sum_type_X_case_mve)\
+				boxed(sum_type_X_case_mve)\
 				default: break;\
 			}\
-			return *this;\
 		}\
-		const char* name() const noexcept {\
-			switch (kind) {\
-				list(sum_type_X_name)\
+		void destroy_kind() noexcept {\
+			switch(kind) {\
+				list(sum_type_X_dst)\
+				boxed(sum_type_X_dst)\
 				default: break;\
 			}\
-			return "??";\
+		}\
+		const char* name() const noexcept {\
+			return kind < Count ? Kind_Name[kind] : "??";\
 		}\
 		bool typecheck(n::Kind k) const noexcept { return kind == k; }\
+		void* data() noexcept {\
+			if constexpr (Inline_Count + 1 < Count) if (Kind_Boxed(kind)) return *(void**)this;\
+			return this;\
+		}\
+		const void* data() const noexcept { return const_cast<n*>(this)->data(); }\
 		template<typename T>\
 		const T& cast() const noexcept {\
 			list(sum_type_X_cast)\
+			boxed(sum_type_X_cast_boxed)\
 			assert("Yeah no.");\
 			return *reinterpret_cast<const T*>(this);\
 		}\
 		template<typename T>\
 		T& cast() noexcept {\
 			list(sum_type_X_cast)\
+			boxed(sum_type_X_cast_boxed)\
 			assert("Yeah no.");\
 			return *reinterpret_cast<T*>(this);\
 		}\
 		template<typename F, typename k>\
 		void on_one_off_help(F f) noexcept {\
 			if (kind != MAP_type_kind<k>::kind) return;\
-			f(*reinterpret_cast<k*>(this));\
+			f(cast<k>());\
 		}\
 		template<typename... kinds>\
 		struct On_One_Off {\
@@ -184,10 +241,10 @@ struct For_Each_ {
 #define for_each_type(...) For_Each_<__VA_ARGS__>() = [&]
 
 #define sum_type_base(base_)\
-	base_* operator->() noexcept { return (base_*)this; }\
-	base_* base() noexcept { return (base_*)this; }\
-	const base_* base() const noexcept { return (const base_*)this; }\
-	const base_* operator->() const noexcept { return (base_*)this; }
+	base_* operator->() noexcept { return (base_*)data(); }\
+	base_* base() noexcept { return (base_*)data(); }\
+	const base_* base() const noexcept { return (const base_*)data(); }\
+	const base_* operator->() const noexcept { return (const base_*)data(); }
 
 #include <chrono>
 
@@ -245,6 +302,7 @@ namespace xstd {
 	struct Pool {
 		inline static size_t ID = 1;
 		xstd::vector<T> pool;
+		// Not a swiss_map, with small integer keys hashmap measured faster (--micro maps).
 		xstd::unordered_map<size_t, size_t> pool_ids;
 
 		void resize(size_t n, T v = {}) noexcept {
@@ -275,6 +333,7 @@ namespace xstd {
 				--i;
 				--s;
 			}
+			PROFILER_COUNTER_ADD("pool removals", pool.size() - s);
 			pool.resize(s);
 		}
 